@@ -21,6 +21,7 @@
 
 #include <SDL_audio.h>
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
@@ -33,6 +34,27 @@
 typedef std::shared_ptr<SDL_AudioStream> AudioStreamPtr;
 typedef std::function<void(SceUID)> ResumeAudioThread;
 
+// Lock-free ring of host samples, written by the thread outputting to a port and read by the audio callback
+class AudioSampleRing {
+public:
+    // must be called before the ring is shared, the size is rounded up to a power of two
+    void init(uint32_t size);
+
+    uint32_t available() const;
+    uint32_t get_capacity() const { return capacity; }
+    // only called by the producer, return the number of bytes written
+    uint32_t write(const uint8_t *data, uint32_t size);
+    // only called by the consumer, return the number of bytes read
+    uint32_t read(uint8_t *data, uint32_t size);
+
+private:
+    std::unique_ptr<uint8_t[]> buffer;
+    uint32_t capacity = 0;
+    // free-running positions, the index in the buffer is the position modulo the capacity
+    std::atomic<uint32_t> read_pos = 0;
+    std::atomic<uint32_t> write_pos = 0;
+};
+
 struct AudioOutPort {
     // Channel range from 0 - 32768
     int left_channel_volume = SCE_AUDIO_VOLUME_0DB;
@@ -52,15 +74,28 @@ struct AudioOutPort {
     int freq = 0;
     int mode = 0;
 
+    // guards the stream, it is never locked by the audio callback
     std::mutex mutex;
-    // stream to get the data
+    // stream to convert the data to the host format
     AudioStreamPtr stream;
+    // converted samples waiting to be mixed by the audio callback
+    AudioSampleRing ring;
+    // buffer used to move the samples from the stream to the ring
+    std::vector<uint8_t> convert_buffer;
     // thread currently waiting for the audio to be processed
-    SceUID thread = -1;
+    std::atomic<SceUID> thread = -1;
+
+    // number of times the audio callback ran short of samples while the port was playing
+    std::atomic<uint32_t> underruns = 0;
+    // largest amount of samples waiting in the ring when the audio callback ran
+    std::atomic<uint32_t> peak_buffered_bytes = 0;
+    // only used by the audio callback
+    bool playing = false;
 };
 
 typedef std::shared_ptr<AudioOutPort> AudioOutPortPtr;
 typedef std::map<int, AudioOutPortPtr> AudioOutPortPtrs;
+typedef std::vector<AudioOutPortPtr> AudioOutPortList;
 
 struct AudioInPort {
     SDL_AudioDeviceID id;
@@ -112,17 +147,35 @@ struct AudioState {
     AudioSpec spec;
     // the adapter must be before out_ports for the destructors to work correctly
     std::unique_ptr<AudioAdapter> adapter;
+    // the variables in this block must be accessed by first locking mutex
     std::mutex mutex;
     int next_port_id = 1;
     AudioOutPortPtrs out_ports;
+    // list of the ports read by the audio callback without locking, it is replaced each time out_ports changes
+    std::atomic<const AudioOutPortList *> mix_ports = nullptr;
+    std::unique_ptr<const AudioOutPortList> mix_ports_owner;
+    // previous lists with the callback count when they were replaced, freed once the callback ran again
+    std::vector<std::pair<uint64_t, std::unique_ptr<const AudioOutPortList>>> retired_mix_ports;
+    std::atomic<uint64_t> callback_count = 0;
+
     AudioInPort in_port;
     ResumeAudioThread resume_thread;
     std::string audio_backend;
     float global_volume;
 
+    ~AudioState();
+
     bool init(const ResumeAudioThread &resume_thread, const std::string &adapter_name);
     void set_backend(const std::string &adapter_name);
     AudioOutPortPtr open_port(int nb_channels, int freq, int nb_sample);
+    // Add an opened port, return its id
+    int add_out_port(const AudioOutPortPtr &port);
+    void set_out_port(int port_id, const AudioOutPortPtr &port);
+    bool release_out_port(int port_id);
+    // Number of bytes of the port not played yet
+    int get_rest_bytes(AudioOutPort &out_port);
+    // Publish out_ports to the audio callback, must be called with mutex locked
+    void update_mix_ports();
     void audio_output(ThreadState &thread, AudioOutPort &out_port, const void *buffer);
     void set_volume(AudioOutPort &out_port, float volume);
     void set_global_volume(float volume);
@@ -27,62 +27,154 @@
 #include <util/log.h>
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstring>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+
+void AudioSampleRing::init(uint32_t size) {
+    capacity = std::bit_ceil(size);
+    buffer = std::make_unique<uint8_t[]>(capacity);
+    read_pos = 0;
+    write_pos = 0;
+}
+
+uint32_t AudioSampleRing::available() const {
+    return write_pos.load(std::memory_order_acquire) - read_pos.load(std::memory_order_acquire);
+}
+
+uint32_t AudioSampleRing::write(const uint8_t *data, uint32_t size) {
+    const uint32_t write_index = write_pos.load(std::memory_order_relaxed);
+    const uint32_t read_index = read_pos.load(std::memory_order_acquire);
+    size = std::min(size, capacity - (write_index - read_index));
+
+    const uint32_t offset = write_index & (capacity - 1);
+    const uint32_t first_part = std::min(size, capacity - offset);
+    memcpy(&buffer[offset], data, first_part);
+    memcpy(&buffer[0], data + first_part, size - first_part);
+
+    write_pos.store(write_index + size, std::memory_order_release);
+    return size;
+}
+
+uint32_t AudioSampleRing::read(uint8_t *data, uint32_t size) {
+    const uint32_t read_index = read_pos.load(std::memory_order_relaxed);
+    const uint32_t write_index = write_pos.load(std::memory_order_acquire);
+    size = std::min(size, write_index - read_index);
+
+    const uint32_t offset = read_index & (capacity - 1);
+    const uint32_t first_part = std::min(size, capacity - offset);
+    memcpy(data, &buffer[offset], first_part);
+    memcpy(data + first_part, &buffer[0], size - first_part);
+
+    read_pos.store(read_index + size, std::memory_order_release);
+    return size;
+}
+
+// dest += src * volume / SDL_MIX_MAXVOLUME with saturation, rounding like SDL_MixAudioFormat does for AUDIO_S16LSB
+static void mix_s16(int16_t *dest, const int16_t *src, const int count, const int volume) {
+    int i = 0;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    const __m128i volume_vec = _mm_set1_epi16(static_cast<int16_t>(volume));
+    const __m128i round_bias = _mm_set1_epi32(SDL_MIX_MAXVOLUME - 1);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i product_low = _mm_mullo_epi16(samples, volume_vec);
+        const __m128i product_high = _mm_mulhi_epi16(samples, volume_vec);
+        __m128i products[2] = { _mm_unpacklo_epi16(product_low, product_high), _mm_unpackhi_epi16(product_low, product_high) };
+        for (__m128i &product : products) {
+            // divide by 128 rounding towards zero
+            const __m128i bias = _mm_and_si128(_mm_srai_epi32(product, 31), round_bias);
+            product = _mm_srai_epi32(_mm_add_epi32(product, bias), 7);
+        }
+        const __m128i scaled = _mm_packs_epi32(products[0], products[1]);
+        const __m128i mixed = _mm_adds_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(dest + i)), scaled);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), mixed);
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    const int16x4_t volume_vec = vdup_n_s16(static_cast<int16_t>(volume));
+    const int32x4_t round_bias = vdupq_n_s32(SDL_MIX_MAXVOLUME - 1);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t samples = vld1q_s16(src + i);
+        int32x4_t products[2] = { vmull_s16(vget_low_s16(samples), volume_vec), vmull_s16(vget_high_s16(samples), volume_vec) };
+        for (int32x4_t &product : products) {
+            // divide by 128 rounding towards zero
+            const int32x4_t bias = vandq_s32(vshrq_n_s32(product, 31), round_bias);
+            product = vshrq_n_s32(vaddq_s32(product, bias), 7);
+        }
+        const int16x8_t scaled = vcombine_s16(vmovn_s32(products[0]), vmovn_s32(products[1]));
+        vst1q_s16(dest + i, vqaddq_s16(vld1q_s16(dest + i), scaled));
+    }
+#endif
+
+    for (; i < count; i++) {
+        const int mixed = dest[i] + src[i] * volume / SDL_MIX_MAXVOLUME;
+        dest[i] = static_cast<int16_t>(std::clamp(mixed, static_cast<int>(INT16_MIN), static_cast<int>(INT16_MAX)));
+    }
+}
+
 static void mix_out_port(uint8_t *stream, uint8_t *temp_buffer, int len, float global_volume, AudioOutPort &port, const ResumeAudioThread &resume_thread) {
     ZoneScopedC(0xF6C2FF); // Tracy - Track function scope with color thistle
 
     // How much data is available?
-    std::unique_lock<std::mutex> lock(port.mutex);
-    const int bytes_available = SDL_AudioStreamAvailable(port.stream.get());
-    assert(bytes_available >= 0);
+    const uint32_t bytes_available = port.ring.available();
+    if (bytes_available > port.peak_buffered_bytes.load(std::memory_order_relaxed))
+        port.peak_buffered_bytes.store(bytes_available, std::memory_order_relaxed);
 
     // Running out of data?
     // The (len * 3) is according to the value in sceAudioOutOutput
-    if (bytes_available < len * 3) {
+    if (bytes_available < static_cast<uint32_t>(len) * 3) {
         // Is there a thread waiting for playback to finish?
-        if (port.thread >= 0) {
+        const SceUID thread = port.thread.exchange(-1);
+        if (thread >= 0) {
             // Wake the thread up.
-            resume_thread(port.thread);
-            port.thread = -1;
+            resume_thread(thread);
         }
     }
 
+    if (port.playing && bytes_available < static_cast<uint32_t>(len))
+        port.underruns.fetch_add(1, std::memory_order_relaxed);
+    port.playing = bytes_available != 0;
+
     if (bytes_available == 0)
         return;
 
     // Mix as much as we need.
-    const int bytes_to_get = std::min(len, bytes_available);
-    const int bytes_got = SDL_AudioStreamGet(port.stream.get(), temp_buffer, bytes_to_get);
-    lock.unlock();
-    if (bytes_got > 0) {
-        SDL_MixAudioFormat(stream, temp_buffer, AUDIO_S16LSB, bytes_got, static_cast<int>(port.volume * global_volume * SDL_MIX_MAXVOLUME));
-    }
+    const uint32_t bytes_got = port.ring.read(temp_buffer, std::min(static_cast<uint32_t>(len), bytes_available));
+    const int volume = static_cast<int>(port.volume * global_volume * SDL_MIX_MAXVOLUME);
+    mix_s16(reinterpret_cast<int16_t *>(stream), reinterpret_cast<const int16_t *>(temp_buffer), bytes_got / sizeof(int16_t), volume);
 }
 
 void AudioAdapter::audio_callback(uint8_t *stream, int len_bytes) {
     tracy::SetThreadName("Host audio thread"); // Tracy - Declare belonging of this function to the audio thread
     ZoneScopedC(0xF6C2FF); // Tracy - Track function scope with color thistle
 
-    std::vector<AudioOutPortPtr> ports;
-    {
-        // Read from shared state.
-        const std::lock_guard<std::mutex> lock(state.mutex);
-        ports.reserve(state.out_ports.size());
-        for (const auto &[_, port] : state.out_ports) {
-            ports.push_back(port);
-        }
-    }
     std::memset(stream, state.spec.silence, len_bytes);
 
-    for (const AudioOutPortPtr &port : ports) {
-        mix_out_port(stream, temp_buffer.data(), len_bytes, state.global_volume, *port.get(), state.resume_thread);
+    // the list stays valid until this callback returns, see AudioState::update_mix_ports
+    const AudioOutPortList *ports = state.mix_ports.load();
+    if (ports) {
+        for (const AudioOutPortPtr &port : *ports) {
+            mix_out_port(stream, temp_buffer.data(), len_bytes, state.global_volume, *port.get(), state.resume_thread);
+        }
     }
+    state.callback_count++;
 
     FrameMarkNamed("Audio"); // Tracy - End discontinuous frame for audio rendering
 }
 
+AudioState::~AudioState() {
+    // stop the audio callback before the lists of ports it reads are freed
+    if (adapter)
+        adapter->switch_state(true);
+}
+
 bool AudioState::init(const ResumeAudioThread &resume_thread, const std::string &adapter_name) {
     this->resume_thread = resume_thread;
 
@@ -98,8 +190,14 @@ void AudioState::set_backend(const std::string &adapter_name) {
         return;
 
     // first delete all ports then delete the backend
-    out_ports.clear();
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        out_ports.clear();
+        update_mix_ports();
+    }
     adapter.reset();
+    // the audio callback is not running anymore, so the old lists can be freed
+    retired_mix_ports.clear();
     if (adapter_name == "SDL") {
         adapter = std::make_unique<SDLAudioAdapter>(*this);
     } else if (adapter_name == "Cubeb") {
@@ -120,6 +218,77 @@ void AudioState::set_backend(const std::string &adapter_name) {
     adapter->temp_buffer.resize(spec.nb_samples * 2 * sizeof(uint16_t));
 }
 
+void AudioState::update_mix_ports() {
+    // free the lists the audio callback stopped using
+    const uint64_t count = callback_count;
+    std::erase_if(retired_mix_ports, [&](const auto &retired) { return retired.first < count; });
+
+    auto ports = std::make_unique<AudioOutPortList>();
+    ports->reserve(out_ports.size());
+    for (const auto &[_, port] : out_ports)
+        ports->push_back(port);
+
+    // a callback which loaded the previous list has returned once callback_count went past its current value
+    mix_ports = ports.get();
+    if (mix_ports_owner)
+        retired_mix_ports.emplace_back(callback_count.load(), std::move(mix_ports_owner));
+    mix_ports_owner = std::move(ports);
+}
+
+int AudioState::add_out_port(const AudioOutPortPtr &port) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    const int port_id = next_port_id++;
+    out_ports.emplace(port_id, port);
+    update_mix_ports();
+
+    return port_id;
+}
+
+void AudioState::set_out_port(int port_id, const AudioOutPortPtr &port) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    out_ports.emplace(port_id, port);
+    update_mix_ports();
+}
+
+bool AudioState::release_out_port(int port_id) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    const auto it = out_ports.find(port_id);
+    if (it == out_ports.end())
+        return false;
+
+    const AudioOutPort &port = *it->second;
+    if (port.underruns > 0)
+        LOG_INFO("Audio port {} ran short of samples {} times, up to {} ms were buffered", port_id, port.underruns.load(), port.peak_buffered_bytes * 1000ULL / (spec.freq * 2 * sizeof(int16_t)));
+
+    out_ports.erase(it);
+    update_mix_ports();
+    return true;
+}
+
+// Move the converted samples to the ring read by the audio callback, the port must be locked
+static void move_converted_samples(AudioOutPort &out_port) {
+    while (true) {
+        const uint32_t free_space = out_port.ring.get_capacity() - out_port.ring.available();
+        const uint32_t size = std::min<uint32_t>(free_space, out_port.convert_buffer.size()) & ~3U;
+        if (size == 0)
+            break;
+
+        const int got = SDL_AudioStreamGet(out_port.stream.get(), out_port.convert_buffer.data(), size);
+        if (got <= 0)
+            break;
+
+        out_port.ring.write(out_port.convert_buffer.data(), got);
+    }
+}
+
+int AudioState::get_rest_bytes(AudioOutPort &out_port) {
+    if (!adapter->single_stream)
+        return 0;
+
+    const std::lock_guard<std::mutex> lock(out_port.mutex);
+    return out_port.ring.available() + SDL_AudioStreamAvailable(out_port.stream.get());
+}
+
 AudioOutPortPtr AudioState::open_port(int nb_channels, int freq, int nb_sample) {
     if (adapter->single_stream) {
         // handle everything here
@@ -132,6 +301,12 @@ AudioOutPortPtr AudioState::open_port(int nb_channels, int freq, int nb_sample)
         port->len_bytes = nb_sample * nb_channels * sizeof(int16_t);
         port->stream = stream;
 
+        // one output once converted to the host format, with some margin for the resampler
+        const uint32_t converted_len = (static_cast<uint64_t>(nb_sample) * spec.freq / freq + 64) * 2 * sizeof(int16_t);
+        port->convert_buffer.resize(converted_len);
+        // big enough for the samples sceAudioOutOutput keeps ahead and the next output
+        port->ring.init(3 * spec.nb_samples * 2 * sizeof(int16_t) + 2 * converted_len);
+
         return port;
     } else {
         // let the adapter open the port
@@ -146,8 +321,9 @@ void AudioState::audio_output(ThreadState &thread, AudioOutPort &out_port, const
         // Put audio to the port's stream and see how much is left to play.
         std::unique_lock<std::mutex> lock(out_port.mutex);
         SDL_AudioStreamPut(out_port.stream.get(), buffer, out_port.len_bytes);
+        move_converted_samples(out_port);
 
-        const int available = SDL_AudioStreamAvailable(out_port.stream.get());
+        const int available = out_port.ring.available() + SDL_AudioStreamAvailable(out_port.stream.get());
         lock.unlock();
 
         // If there's lots of audio left to play, stop this thread.
@@ -158,11 +334,17 @@ void AudioState::audio_output(ThreadState &thread, AudioOutPort &out_port, const
         // but this would give a bad audio because the host buffer size is different compared to the guest buffer size
         // so we need to cache more data to make sure we always have enough
         if (available >= 3 * spec.nb_samples * 2 * sizeof(uint16_t)) {
-            out_port.thread = thread.id;
-
             std::unique_lock<std::mutex> mlock(thread.mutex);
             thread.update_status(ThreadStatus::wait);
+            // set with the thread locked, so the audio callback cannot resume it before it waits
+            out_port.thread = thread.id;
             thread.status_cond.wait(mlock, [&]() { return thread.status == ThreadStatus::run; });
+            mlock.unlock();
+
+            // the audio callback cannot read the stream, what did not fit in the ring is moved now that it is running low
+            // instead of waiting for the next output of the game
+            const std::lock_guard<std::mutex> guard(out_port.mutex);
+            move_converted_samples(out_port);
         }
     } else {
         adapter->audio_output(thread, out_port, buffer);
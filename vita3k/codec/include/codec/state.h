@@ -17,9 +17,15 @@
 
 #pragma once
 
+#include <array>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <mutex>
 #include <queue>
 #include <string>
+#include <thread>
+#include <vector>
 
 struct AVFrame;
 struct AVPacket;
@@ -89,6 +95,8 @@ struct H264DecoderOptions {
 
 struct H264DecoderState : public DecoderState {
     AVCodecParserContext *parser{};
+    // reused by every call to receive
+    AVFrame *frame{};
 
     uint32_t width_in = 0;
     uint32_t height_in = 0;
@@ -241,42 +249,118 @@ struct AacDecoderState : public DecoderState {
     ~AacDecoderState() override;
 };
 
+// Video frame decoded ahead by the thread of a PlayerState
+struct PlayerVideoFrame {
+    std::vector<uint8_t> data;
+    DecoderSize size{};
+    uint64_t timestamp = 0;
+    // microseconds since the start of the first video, used to pace the frames
+    uint64_t presentation_time = 0;
+};
+
+struct PlayerAudioFrame {
+    std::vector<int16_t> data;
+    uint32_t channels = 0;
+    uint32_t sample_rate = 0;
+    uint32_t sample_count = 0;
+};
+
+// Bounded ring of decoded frames, the slots keep their buffers so they are only allocated once
+template <typename Frame, size_t Size>
+struct PlayerFrameRing {
+    std::array<Frame, Size> frames;
+    size_t head = 0;
+    size_t count = 0;
+
+    bool empty() const { return count == 0; }
+    bool full() const { return count == Size; }
+    Frame &front() { return frames[head]; }
+    // first free slot, filled by the decoding thread before calling push
+    Frame &next_slot() { return frames[(head + count) % Size]; }
+    void push() { count++; }
+    void pop() {
+        head = (head + 1) % Size;
+        count--;
+    }
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+};
+
 struct PlayerState {
+    static constexpr size_t VIDEO_FRAME_COUNT = 8;
+    static constexpr size_t AUDIO_FRAME_COUNT = 16;
+
+    // the variables in this block must be accessed by first locking decoder_mutex, the decoding thread holds it while decoding
+    std::mutex decoder_mutex;
     std::string video_playing;
     std::queue<std::string> videos_queue;
 
     AVFormatContext *format{};
     AVCodecContext *video_context{};
     AVCodecContext *audio_context{};
+    AVFrame *frame{};
     int32_t video_stream_id = -1;
     int32_t audio_stream_id = -1;
 
     std::queue<AVPacket *> audio_packets;
     std::queue<AVPacket *> video_packets;
 
-    uint64_t time_of_last_frame = 0;
-    uint64_t framerate_microseconds = 0;
-
+    // presentation time of the start of the current video and of the end of its last frame
+    uint64_t timeline_offset = 0;
+    uint64_t timeline_end = 0;
+
+    // the variables in this block must be accessed by first locking frames_mutex
+    std::mutex frames_mutex;
+    std::condition_variable frames_cond;
+    PlayerFrameRing<PlayerVideoFrame, VIDEO_FRAME_COUNT> video_frames;
+    PlayerFrameRing<PlayerAudioFrame, AUDIO_FRAME_COUNT> audio_frames;
+    DecoderSize video_size{};
+    bool decode_video = false;
+    bool decode_audio = false;
+    bool stopping = false;
+
+    std::thread decoder_thread;
+
+    // the variables in this block are only used by the thread calling the player
+    uint64_t clock_start = 0;
+    bool clock_started = false;
     uint64_t last_timestamp = 0;
     uint32_t last_channels = 0;
     uint32_t last_sample_rate = 0;
     uint32_t last_sample_count = 0;
 
     DecoderSize get_size();
-    uint64_t get_framerate_microseconds();
+    // true until the last video ended and all its frames were received
+    bool is_active();
 
+    // Discard the current video and play the next one of the queue
     void pop_video();
     void free_video();
-    void switch_video(const std::string &path);
-
-    bool next_packet(int32_t stream_id);
-
-    std::vector<int16_t> receive_audio();
-    std::vector<uint8_t> receive_video();
-
     void queue(const std::string &path);
 
+    /**
+     * \brief Receive the oldest decoded video frame without blocking and drop it.
+     * \param now Current time in microseconds, the frame is only received once it is due
+     * \param receive Called with frames_mutex locked, so the frame can't be reused by the decoding thread meanwhile
+     * \return false if no frame is due
+     */
+    bool receive_video_frame(uint64_t now, const std::function<void(const PlayerVideoFrame &)> &receive);
+    // Same for the oldest decoded audio frame, waiting for the decoding thread if wait is set, the frame is only dropped if pop is set
+    bool receive_audio_frame(bool wait, bool pop, const std::function<void(const PlayerAudioFrame &)> &receive);
+
     ~PlayerState();
+
+private:
+    uint64_t get_framerate_microseconds();
+    void close_video();
+    void switch_video(const std::string &path);
+    bool next_packet(int32_t stream_id);
+    bool receive_frame(AVCodecContext *context, int32_t stream_id);
+    void decode_video_frame();
+    void decode_audio_frame();
+    void decoder_loop();
 };
 
 void convert_rgb_to_yuv(const uint8_t *rgba, uint8_t *yuv, uint32_t width, uint32_t height, const DecoderColorSpace color_space, int32_t in_pitch);
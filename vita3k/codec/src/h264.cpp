@@ -25,31 +25,64 @@ extern "C" {
 
 #include <cassert>
 
-void copy_yuv_data_from_frame(AVFrame *frame, uint8_t *dest, const uint32_t width, const uint32_t height, bool is_p3) {
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+
+// copy the rows of a plane, in a single copy when the source rows have no padding
+static void copy_plane(uint8_t *dest, const uint8_t *src, const int src_pitch, const uint32_t width, const uint32_t height) {
+    if (src_pitch == static_cast<int>(width)) {
+        memcpy(dest, src, width * height);
+        return;
+    }
+
     for (size_t i = 0; i < height; i++) {
-        memcpy(dest, &frame->data[0][frame->linesize[0] * i], width);
+        memcpy(dest, src + static_cast<ptrdiff_t>(src_pitch) * i, width);
         dest += width;
     }
+}
+
+// interleave a row of U and V samples, as in the p2 (NV12) format
+static void interleave_uv(uint8_t *dest, const uint8_t *src_u, const uint8_t *src_v, const uint32_t count) {
+    uint32_t j = 0;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    for (; j + 16 <= count; j += 16) {
+        const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src_u + j));
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src_v + j));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + j * 2), _mm_unpacklo_epi8(u, v));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + j * 2 + 16), _mm_unpackhi_epi8(u, v));
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    for (; j + 16 <= count; j += 16) {
+        const uint8x16x2_t uv = { { vld1q_u8(src_u + j), vld1q_u8(src_v + j) } };
+        vst2q_u8(dest + j * 2, uv);
+    }
+#endif
+
+    for (; j < count; j++) {
+        dest[j * 2] = src_u[j];
+        dest[j * 2 + 1] = src_v[j];
+    }
+}
+
+void copy_yuv_data_from_frame(AVFrame *frame, uint8_t *dest, const uint32_t width, const uint32_t height, bool is_p3) {
+    copy_plane(dest, frame->data[0], frame->linesize[0], width, height);
+    dest += width * height;
 
     if (is_p3) {
-        for (size_t i = 0; i < height / 2; i++) {
-            memcpy(dest, &frame->data[1][frame->linesize[1] * i], width / 2);
-            dest += width / 2;
-        }
-        for (size_t i = 0; i < height / 2; i++) {
-            memcpy(dest, &frame->data[2][frame->linesize[2] * i], width / 2);
-            dest += width / 2;
-        }
+        copy_plane(dest, frame->data[1], frame->linesize[1], width / 2, height / 2);
+        dest += (width / 2) * (height / 2);
+        copy_plane(dest, frame->data[2], frame->linesize[2], width / 2, height / 2);
     } else {
         // p2 format, U and V are interleaved
         for (size_t i = 0; i < height / 2; i++) {
             const uint8_t *src_u = &frame->data[1][frame->linesize[1] * i];
             const uint8_t *src_v = &frame->data[2][frame->linesize[2] * i];
-            for (size_t j = 0; j < width / 2; j++) {
-                dest[0] = src_u[j];
-                dest[1] = src_v[j];
-                dest += 2;
-            }
+            interleave_uv(dest, src_u, src_v, width / 2);
+            dest += width;
         }
     }
 }
@@ -108,12 +141,9 @@ bool H264DecoderState::send(const uint8_t *data, uint32_t size) {
 }
 
 bool H264DecoderState::receive(uint8_t *data, DecoderSize *size) {
-    AVFrame *frame = av_frame_alloc();
-
     int error = avcodec_receive_frame(context, frame);
     if (error < 0) {
         LOG_WARN("Error receiving H264 frame: {}.", codec_error_name(error));
-        av_frame_free(&frame);
         return false;
     }
 
@@ -130,7 +160,8 @@ bool H264DecoderState::receive(uint8_t *data, DecoderSize *size) {
 
     pts_out = frame->pts;
 
-    av_frame_free(&frame);
+    // give the picture back to the decoder, the frame itself is kept for the next call
+    av_frame_unref(frame);
     return true;
 }
 
@@ -175,8 +206,12 @@ H264DecoderState::H264DecoderState(uint32_t width, uint32_t height) {
 
     int result = avcodec_open2(context, codec, nullptr);
     assert(result == 0);
+
+    frame = av_frame_alloc();
+    assert(frame);
 }
 
 H264DecoderState::~H264DecoderState() {
+    av_frame_free(&frame);
     av_parser_close(parser);
 }
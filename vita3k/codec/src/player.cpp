@@ -25,26 +25,66 @@ extern "C" {
 #include <libavformat/avformat.h>
 }
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 
 uint64_t PlayerState::get_framerate_microseconds() {
     AVRational rational = format->streams[video_stream_id]->avg_frame_rate;
+    if (rational.num == 0)
+        return 1000000ull / 30;
     return 1000000ull * rational.den / rational.num;
 }
 
 DecoderSize PlayerState::get_size() {
-    if (video_context)
-        return { { static_cast<uint32_t>(video_context->width), static_cast<uint32_t>(video_context->height) } };
+    const std::lock_guard<std::mutex> lock(frames_mutex);
+    return video_size;
+}
 
-    return {};
+bool PlayerState::is_active() {
+    const std::lock_guard<std::mutex> lock(frames_mutex);
+    return decode_video || decode_audio || !video_frames.empty();
 }
 
 void PlayerState::pop_video() {
+    const std::lock_guard<std::mutex> guard(decoder_mutex);
+    if (videos_queue.empty())
+        return;
+
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        video_frames.clear();
+        audio_frames.clear();
+    }
+    timeline_offset = 0;
+    timeline_end = 0;
+    clock_started = false;
+
     switch_video(videos_queue.front());
     videos_queue.pop();
 }
 
 void PlayerState::free_video() {
+    const std::lock_guard<std::mutex> guard(decoder_mutex);
+    close_video();
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        video_frames.clear();
+        audio_frames.clear();
+    }
+    timeline_offset = 0;
+    timeline_end = 0;
+    clock_started = false;
+    frames_cond.notify_all();
+}
+
+void PlayerState::close_video() {
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        decode_video = false;
+        decode_audio = false;
+    }
+
     if (video_context)
         avcodec_free_context(&video_context);
 
@@ -70,8 +110,10 @@ void PlayerState::free_video() {
 }
 
 void PlayerState::switch_video(const std::string &path) {
-    free_video();
+    close_video();
     video_playing = path;
+    // the frames of the new video are shown after those of the previous one
+    timeline_offset = timeline_end;
 
     int error = avformat_open_input(&format, path.c_str(), nullptr, nullptr);
     assert(error == 0);
@@ -88,6 +130,9 @@ void PlayerState::switch_video(const std::string &path) {
         const AVCodec *video_codec = avcodec_find_decoder(video_stream->codecpar->codec_id);
         video_context = avcodec_alloc_context3(video_codec);
         avcodec_parameters_to_context(video_context, video_stream->codecpar);
+        // the frames are decoded ahead, so the latency of frame threading does not matter
+        video_context->thread_count = 0;
+        video_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
         avcodec_open2(video_context, video_codec, nullptr);
     }
 
@@ -98,6 +143,15 @@ void PlayerState::switch_video(const std::string &path) {
         avcodec_parameters_to_context(audio_context, audio_stream->codecpar);
         avcodec_open2(audio_context, audio_codec, nullptr);
     }
+
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        if (video_context)
+            video_size = { { static_cast<uint32_t>(video_context->width), static_cast<uint32_t>(video_context->height) } };
+        decode_video = video_stream_id >= 0;
+        decode_audio = audio_stream_id >= 0;
+    }
+    frames_cond.notify_all();
 }
 
 bool PlayerState::next_packet(int32_t stream_id) {
@@ -124,114 +178,204 @@ bool PlayerState::next_packet(int32_t stream_id) {
         }
 
         AVPacket *packet = av_packet_alloc();
-        if (av_read_frame(format, packet) != 0)
+        if (av_read_frame(format, packet) != 0) {
+            av_packet_free(&packet);
             return false;
+        }
 
         if (packet->stream_index == stream_id) {
             this_queue.push(packet);
-        } else {
+        } else if (packet->stream_index == video_stream_id || packet->stream_index == audio_stream_id) {
             other_queue.push(packet);
+        } else {
+            av_packet_free(&packet);
         }
     }
 }
 
-std::vector<int16_t> PlayerState::receive_audio() {
-    if (audio_stream_id < 0)
-        return {};
-
-    if (video_playing.empty())
-        return {};
-
-    AVFrame *frame = av_frame_alloc();
-    std::vector<int16_t> data;
+// Receive the next frame of the stream in frame, return false at the end of the stream
+bool PlayerState::receive_frame(AVCodecContext *context, int32_t stream_id) {
     while (true) {
-        int error = avcodec_receive_frame(audio_context, frame);
-
-        if (error == AVERROR(EAGAIN) && next_packet(audio_stream_id))
+        const int error = avcodec_receive_frame(context, frame);
+        if (error == AVERROR(EAGAIN) && next_packet(stream_id))
             continue;
 
-        if (error != 0) {
-            if (videos_queue.empty()) {
-                // Stop playing videos or
-                video_playing.clear();
-                break;
-            } else {
-                // Play the next video (if there is any).
-                switch_video(videos_queue.front());
-                videos_queue.pop();
-                continue;
-            }
-        }
+        return error == 0;
+    }
+}
 
-        LOG_WARN_IF(frame->format != AV_SAMPLE_FMT_FLTP, "Unknown audio format {}.", frame->format);
+void PlayerState::decode_video_frame() {
+    if (!receive_frame(video_context, video_stream_id)) {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        decode_video = false;
+        return;
+    }
 
-        last_channels = frame->ch_layout.nb_channels;
-        last_sample_count = frame->nb_samples;
-        last_sample_rate = frame->sample_rate;
+    const AVStream *stream = format->streams[video_stream_id];
+    uint64_t presentation_time = timeline_end;
+    if (frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+        const int64_t start_time = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+        presentation_time = timeline_offset + std::max<int64_t>(av_rescale_q(frame->best_effort_timestamp - start_time, stream->time_base, AVRational{ 1, 1000000 }), 0);
+    }
+    timeline_end = std::max(timeline_end, presentation_time + get_framerate_microseconds());
+
+    // the slot is not visible to the player until it is pushed, so it is filled without the lock
+    PlayerVideoFrame *slot;
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        slot = &video_frames.next_slot();
+    }
+    slot->size = { { static_cast<uint32_t>(frame->width), static_cast<uint32_t>(frame->height) } };
+    slot->data.resize(H264DecoderState::buffer_size(slot->size));
+    copy_yuv_data_from_frame(frame, slot->data.data(), frame->width, frame->height, false);
+    slot->timestamp = frame->best_effort_timestamp;
+    slot->presentation_time = presentation_time;
+    av_frame_unref(frame);
+
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        video_frames.push();
+    }
+    frames_cond.notify_all();
+}
 
-        data.resize(frame->nb_samples * frame->ch_layout.nb_channels);
+void PlayerState::decode_audio_frame() {
+    if (!receive_frame(audio_context, audio_stream_id)) {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        decode_audio = false;
+        return;
+    }
 
-        for (int a = 0; a < frame->nb_samples; a++) {
-            for (int b = 0; b < frame->ch_layout.nb_channels; b++) {
-                auto *frame_data = reinterpret_cast<float *>(frame->data[b]);
-                float current_sample = frame_data[a];
-                int16_t pcm_sample = current_sample * INT16_MAX;
+    LOG_WARN_IF(frame->format != AV_SAMPLE_FMT_FLTP, "Unknown audio format {}.", frame->format);
 
-                data[a * frame->ch_layout.nb_channels + b] = pcm_sample;
-            }
+    PlayerAudioFrame *slot;
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        slot = &audio_frames.next_slot();
+    }
+    const int channels = frame->ch_layout.nb_channels;
+    slot->channels = channels;
+    slot->sample_count = frame->nb_samples;
+    slot->sample_rate = frame->sample_rate;
+    slot->data.resize(frame->nb_samples * channels);
+
+    for (int a = 0; a < frame->nb_samples; a++) {
+        for (int b = 0; b < channels; b++) {
+            auto *frame_data = reinterpret_cast<float *>(frame->data[b]);
+            float current_sample = frame_data[a];
+            int16_t pcm_sample = current_sample * INT16_MAX;
+
+            slot->data[a * channels + b] = pcm_sample;
         }
-
-        break;
     }
+    av_frame_unref(frame);
 
-    av_frame_free(&frame);
-    return data;
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        audio_frames.push();
+    }
+    frames_cond.notify_all();
 }
 
-std::vector<uint8_t> PlayerState::receive_video() {
-    if (video_stream_id < 0)
-        return {};
-
-    if (video_playing.empty())
-        return {};
-
-    AVFrame *frame = av_frame_alloc();
-    std::vector<uint8_t> data;
+void PlayerState::decoder_loop() {
     while (true) {
-        int error = avcodec_receive_frame(video_context, frame);
+        bool needs_video;
+        bool needs_audio;
+        {
+            std::unique_lock<std::mutex> lock(frames_mutex);
+            frames_cond.wait(lock, [&]() {
+                return stopping || (decode_video && !video_frames.full()) || (decode_audio && !audio_frames.full());
+            });
+            if (stopping)
+                return;
+
+            needs_video = decode_video && !video_frames.full();
+            needs_audio = decode_audio && !audio_frames.full();
+        }
 
-        if (error == AVERROR(EAGAIN) && next_packet(video_stream_id))
+        const std::lock_guard<std::mutex> guard(decoder_mutex);
+        // the video may have been stopped or switched while waiting for the lock
+        if (video_playing.empty())
             continue;
 
-        if (error != 0) {
+        if (needs_video && video_context)
+            decode_video_frame();
+        if (needs_audio && audio_context)
+            decode_audio_frame();
+
+        bool ended;
+        {
+            const std::lock_guard<std::mutex> lock(frames_mutex);
+            // the video ends with its video stream, the audio left is dropped as the player did before
+            ended = video_stream_id >= 0 ? !decode_video : !decode_audio;
+        }
+        if (ended) {
             if (videos_queue.empty()) {
-                // Stop playing videos or
-                video_playing.clear();
-                break;
+                close_video();
             } else {
                 // Play the next video (if there is any).
                 switch_video(videos_queue.front());
                 videos_queue.pop();
-                continue;
             }
         }
+    }
+}
 
-        last_timestamp = frame->best_effort_timestamp;
+bool PlayerState::receive_video_frame(uint64_t now, const std::function<void(const PlayerVideoFrame &)> &receive) {
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        if (video_frames.empty())
+            return false;
+
+        const PlayerVideoFrame &video_frame = video_frames.front();
+        if (!clock_started) {
+            clock_start = now - video_frame.presentation_time;
+            clock_started = true;
+        }
 
-        data.resize(H264DecoderState::buffer_size(
-            { { static_cast<uint32_t>(video_context->width), static_cast<uint32_t>(video_context->height) } }));
-        copy_yuv_data_from_frame(frame, data.data(), frame->width, frame->height, false);
+        if (clock_start + video_frame.presentation_time > now)
+            return false;
 
-        break;
+        receive(video_frame);
+        last_timestamp = video_frame.timestamp;
+        video_frames.pop();
     }
+    frames_cond.notify_all();
+    return true;
+}
+
+bool PlayerState::receive_audio_frame(bool wait, bool pop, const std::function<void(const PlayerAudioFrame &)> &receive) {
+    {
+        std::unique_lock<std::mutex> lock(frames_mutex);
+        if (wait)
+            frames_cond.wait_for(lock, std::chrono::seconds(1), [&]() { return !audio_frames.empty() || !decode_audio; });
+
+        if (audio_frames.empty())
+            return false;
 
-    av_frame_free(&frame);
-    return data;
+        const PlayerAudioFrame &audio_frame = audio_frames.front();
+        receive(audio_frame);
+        if (!pop)
+            return true;
+
+        last_channels = audio_frame.channels;
+        last_sample_rate = audio_frame.sample_rate;
+        last_sample_count = audio_frame.sample_count;
+        audio_frames.pop();
+    }
+    frames_cond.notify_all();
+    return true;
 }
 
 void PlayerState::queue(const std::string &path) {
     if (fs::exists(path)) {
         LOG_INFO("Queued video: '{}'.", path);
+        const std::lock_guard<std::mutex> guard(decoder_mutex);
+        if (!frame)
+            frame = av_frame_alloc();
+        if (!decoder_thread.joinable())
+            decoder_thread = std::thread(&PlayerState::decoder_loop, this);
+
         if (video_playing.empty())
             switch_video(path);
         else
@@ -242,8 +386,17 @@ void PlayerState::queue(const std::string &path) {
 }
 
 PlayerState::~PlayerState() {
-    free_video();
+    {
+        const std::lock_guard<std::mutex> lock(frames_mutex);
+        stopping = true;
+    }
+    frames_cond.notify_all();
+    if (decoder_thread.joinable())
+        decoder_thread.join();
+
+    close_video();
+    if (frame)
+        av_frame_free(&frame);
 
-    video_playing.clear();
     videos_queue = {};
 }
@@ -38,11 +38,14 @@ typedef std::function<Address(Address)> GetWatchMemoryAddr;
 typedef std::unique_ptr<CPUState, std::function<void(CPUState *)>> CPUStatePtr;
 typedef std::unique_ptr<CPUInterface> CPUInterfacePtr;
 typedef void *ExclusiveMonitorPtr;
+// shared by the kernel and the threads using it, so it outlives the threads still running when the kernel is destroyed
+typedef std::shared_ptr<void> JitPoolPtr;
 
 struct CPUProtocolBase {
     virtual void call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState &thread) = 0;
     virtual Address get_watch_memory_addr(Address addr) = 0;
     virtual ExclusiveMonitorPtr get_exclusive_monitor() = 0;
+    virtual JitPoolPtr get_jit_pool() = 0;
     virtual ~CPUProtocolBase() = default;
 };
 
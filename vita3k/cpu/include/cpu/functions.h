@@ -48,6 +48,7 @@ bool is_thumb_mode(CPUState &state);
 CPUContext save_context(CPUState &state);
 void load_context(CPUState &state, const CPUContext &ctx);
 std::size_t get_processor_id(CPUState &state);
+void clear_exclusive(CPUState &state);
 void invalidate_jit_cache(CPUState &state, Address start, size_t length);
 
 uint32_t read_fpscr(CPUState &state);
@@ -62,6 +63,9 @@ ExclusiveMonitorPtr new_exclusive_monitor(int max_num_cores);
 void free_exclusive_monitor(ExclusiveMonitorPtr monitor);
 void clear_exclusive(ExclusiveMonitorPtr monitor, std::size_t core_num);
 
+JitPoolPtr new_jit_pool(ExclusiveMonitorPtr monitor, std::size_t first_core_id, std::size_t max_count);
+void invalidate_jit_pool(const JitPoolPtr &pool, Address start, size_t length);
+
 // Debugging helpers
 std::string disassemble(CPUState &state, uint64_t at, bool thumb, uint16_t *insn_size = nullptr);
 std::string disassemble(CPUState &state, uint64_t at, uint16_t *insn_size = nullptr);
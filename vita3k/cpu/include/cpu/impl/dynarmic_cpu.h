@@ -22,20 +22,72 @@
 #include <cpu/functions.h>
 #include <cpu/impl/interface.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 class ArmDynarmicCallback;
 class ArmDynarmicCP15;
+class DynarmicCPU;
+
+/*! \brief JIT instance which can be used by any guest thread, along with the objects it was created with */
+struct SharedJit {
+    std::unique_ptr<ArmDynarmicCallback> cb;
+    std::shared_ptr<ArmDynarmicCP15> cp15;
+    std::unique_ptr<Dynarmic::A32::Jit> jit;
+    std::size_t core_id;
+    // set while a thread is running on it
+    std::atomic<bool> in_use = false;
+    // last thread which ran on it, written by the thread which sets in_use
+    DynarmicCPU *last_cpu = nullptr;
+};
+
+/*! \brief Pool of JIT instances shared by all the guest threads
+ *
+ * A thread only holds a JIT while it is running guest code (it is given back before each HLE call),
+ * so the number of instances is bounded by the number of threads running at the same time and the
+ * code translated for a thread is reused by all the threads which later use the same instance.
+ * A thread first tries to take back the JIT it used last, which does not need the lock and keeps
+ * its exclusive state if no other thread ran on it meanwhile.
+ */
+class DynarmicJitPool {
+    // guards the creation of the JITs, the vector is never shrunk
+    std::mutex mutex;
+    std::vector<std::unique_ptr<SharedJit>> jits;
+    Dynarmic::ExclusiveMonitor *monitor;
+    // the pool uses the exclusive monitor processor ids [first_core_id, first_core_id + max_count)
+    std::size_t first_core_id;
+    std::size_t max_count;
+
+public:
+    DynarmicJitPool(Dynarmic::ExclusiveMonitor *monitor, std::size_t first_core_id, std::size_t max_count);
+
+    // return nullptr if all the JIT instances are already in use
+    SharedJit *acquire(DynarmicCPU &cpu, SharedJit *last_jit);
+    void release(SharedJit *shared_jit);
+    void invalidate_jit_cache(Address start, size_t length);
+};
 
 class DynarmicCPU : public CPUInterface {
     friend class ArmDynarmicCallback;
+    friend class DynarmicJitPool;
 
     CPUState *parent;
 
-    std::unique_ptr<Dynarmic::A32::Jit> jit;
+    // JIT currently in use, null if the thread is not running and its JIT is shared
+    Dynarmic::A32::Jit *jit = nullptr;
+    // JIT owned by this thread, used if the pool is disabled, full or if logging is enabled
+    std::unique_ptr<Dynarmic::A32::Jit> own_jit;
     std::unique_ptr<ArmDynarmicCallback> cb;
     std::shared_ptr<ArmDynarmicCP15> cp15;
     Dynarmic::ExclusiveMonitor *monitor;
+    std::shared_ptr<DynarmicJitPool> jit_pool;
+    SharedJit *shared_jit = nullptr;
+    // JIT of the pool this thread ran on last, tried first on the next run
+    SharedJit *last_shared_jit = nullptr;
+    // state of the thread while it does not hold a JIT
+    CPUContext saved_ctx;
 
     std::size_t core_id = 0;
 
@@ -47,10 +99,14 @@ class DynarmicCPU : public CPUInterface {
     bool log_code = false;
     bool cpu_opt;
 
-    std::unique_ptr<Dynarmic::A32::Jit> make_jit();
+    std::unique_ptr<Dynarmic::A32::Jit> make_jit(ArmDynarmicCallback *callback, const std::shared_ptr<ArmDynarmicCP15> &coprocessor, std::size_t processor_id);
+    bool use_shared_jit() const;
+    void update_own_jit();
+    void acquire_jit();
+    void release_jit();
 
 public:
-    DynarmicCPU(CPUState *state, std::size_t processor_id, Dynarmic::ExclusiveMonitor *monitor, bool cpu_opt);
+    DynarmicCPU(CPUState *state, std::size_t processor_id, Dynarmic::ExclusiveMonitor *monitor, std::shared_ptr<DynarmicJitPool> jit_pool, bool cpu_opt);
     ~DynarmicCPU() override;
     int run() override;
     void stop() override;
@@ -93,5 +149,6 @@ public:
     bool get_log_mem() override;
 
     std::size_t processor_id() const override;
+    void clear_exclusive() override;
     void invalidate_jit_cache(Address start, size_t length) override;
 };
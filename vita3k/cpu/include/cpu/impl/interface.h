@@ -69,4 +69,7 @@ struct CPUInterface {
     virtual std::size_t processor_id() const {
         return 0;
     }
+
+    // Clear the exclusive state of the core the thread is currently running on
+    virtual void clear_exclusive() {}
 };
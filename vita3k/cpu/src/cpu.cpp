@@ -60,7 +60,8 @@ CPUStatePtr init_cpu(CPUBackend backend, bool cpu_opt, SceUID thread_id, std::si
     switch (backend) {
     case CPUBackend::Dynarmic: {
         Dynarmic::ExclusiveMonitor *monitor = static_cast<Dynarmic::ExclusiveMonitor *>(protocol->get_exclusive_monitor());
-        state->cpu = std::make_unique<DynarmicCPU>(state.get(), processor_id, monitor, cpu_opt);
+        auto jit_pool = std::static_pointer_cast<DynarmicJitPool>(protocol->get_jit_pool());
+        state->cpu = std::make_unique<DynarmicCPU>(state.get(), processor_id, monitor, std::move(jit_pool), cpu_opt);
         break;
     }
     case CPUBackend::Unicorn: {
@@ -182,6 +183,10 @@ std::size_t get_processor_id(CPUState &state) {
     return state.cpu->processor_id();
 }
 
+void clear_exclusive(CPUState &state) {
+    state.cpu->clear_exclusive();
+}
+
 void invalidate_jit_cache(CPUState &state, Address start, size_t length) {
     state.cpu->invalidate_jit_cache(start, length);
 }
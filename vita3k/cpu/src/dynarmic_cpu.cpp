@@ -103,6 +103,12 @@ public:
 
     ~ArmDynarmicCallback() override = default;
 
+    // used by the shared JITs, which run a different thread each time they are acquired
+    void bind(CPUState &parent, DynarmicCPU &cpu) {
+        this->parent = &parent;
+        this->cpu = &cpu;
+    }
+
     std::optional<std::uint32_t> MemoryReadCode(Dynarmic::A32::VAddr addr) override {
         if (cpu->log_mem)
             LOG_TRACE("Instruction fetch at address 0x{:X}", addr);
@@ -298,10 +304,10 @@ public:
     }
 };
 
-std::unique_ptr<Dynarmic::A32::Jit> DynarmicCPU::make_jit() {
+std::unique_ptr<Dynarmic::A32::Jit> DynarmicCPU::make_jit(ArmDynarmicCallback *callback, const std::shared_ptr<ArmDynarmicCP15> &coprocessor, std::size_t processor_id) {
     Dynarmic::A32::UserConfig config{};
     config.arch_version = Dynarmic::A32::ArchVersion::v7;
-    config.callbacks = cb.get();
+    config.callbacks = callback;
     if (parent->mem->use_page_table) {
         config.page_table = (log_mem || !cpu_opt) ? nullptr : reinterpret_cast<decltype(config.page_table)>(parent->mem->page_table.get());
         config.absolute_offset_page_table = true;
@@ -311,37 +317,147 @@ std::unique_ptr<Dynarmic::A32::Jit> DynarmicCPU::make_jit() {
     config.hook_hint_instructions = true;
     config.enable_cycle_counting = false;
     config.global_monitor = monitor;
-    config.coprocessors[15] = cp15;
-    config.processor_id = core_id;
+    config.coprocessors[15] = coprocessor;
+    config.processor_id = processor_id;
     config.optimizations = cpu_opt ? Dynarmic::all_safe_optimizations : Dynarmic::no_optimizations;
 
     return std::make_unique<Dynarmic::A32::Jit>(config);
 }
 
-DynarmicCPU::DynarmicCPU(CPUState *state, std::size_t processor_id, Dynarmic::ExclusiveMonitor *monitor, bool cpu_opt)
+DynarmicJitPool::DynarmicJitPool(Dynarmic::ExclusiveMonitor *monitor, std::size_t first_core_id, std::size_t max_count)
+    : monitor(monitor)
+    , first_core_id(first_core_id)
+    , max_count(max_count) {
+}
+
+SharedJit *DynarmicJitPool::acquire(DynarmicCPU &cpu, SharedJit *last_jit) {
+    SharedJit *shared_jit = nullptr;
+    if (last_jit && !last_jit->in_use.exchange(true, std::memory_order_acquire)) {
+        shared_jit = last_jit;
+    } else {
+        const std::lock_guard<std::mutex> guard(mutex);
+        for (const auto &jit : jits) {
+            if (!jit->in_use.exchange(true, std::memory_order_acquire)) {
+                shared_jit = jit.get();
+                break;
+            }
+        }
+
+        if (!shared_jit) {
+            if (jits.size() >= max_count)
+                return nullptr;
+
+            // all the JITs are created with the same config, so it doesn't matter which thread creates it
+            auto new_jit = std::make_unique<SharedJit>();
+            new_jit->cb = std::make_unique<ArmDynarmicCallback>(*cpu.parent, cpu);
+            new_jit->cp15 = std::make_shared<ArmDynarmicCP15>();
+            new_jit->core_id = first_core_id + jits.size();
+            new_jit->jit = cpu.make_jit(new_jit->cb.get(), new_jit->cp15, new_jit->core_id);
+            new_jit->in_use = true;
+            shared_jit = jits.emplace_back(std::move(new_jit)).get();
+        }
+    }
+
+    // the exclusive state only has to be cleared on a context switch
+    if (shared_jit->last_cpu != &cpu || shared_jit != last_jit) {
+        shared_jit->jit->ClearExclusiveState();
+        monitor->ClearProcessor(shared_jit->core_id);
+        shared_jit->cb->bind(*cpu.parent, cpu);
+        shared_jit->last_cpu = &cpu;
+    }
+    shared_jit->cp15->set_tpidruro(cpu.cp15->get_tpidruro());
+
+    return shared_jit;
+}
+
+void DynarmicJitPool::release(SharedJit *shared_jit) {
+    shared_jit->in_use.store(false, std::memory_order_release);
+}
+
+void DynarmicJitPool::invalidate_jit_cache(Address start, size_t length) {
+    const std::lock_guard<std::mutex> guard(mutex);
+    for (auto &shared_jit : jits)
+        shared_jit->jit->InvalidateCacheRange(start, length);
+}
+
+DynarmicCPU::DynarmicCPU(CPUState *state, std::size_t processor_id, Dynarmic::ExclusiveMonitor *monitor, std::shared_ptr<DynarmicJitPool> jit_pool, bool cpu_opt)
     : parent(state)
     , cb(std::make_unique<ArmDynarmicCallback>(*state, *this))
     , cp15(std::make_shared<ArmDynarmicCP15>())
     , monitor(monitor)
+    , jit_pool(std::move(jit_pool))
     , core_id(processor_id)
     , cpu_opt(cpu_opt) {
-    jit = make_jit();
+    update_own_jit();
+}
+
+DynarmicCPU::~DynarmicCPU() {
+    if (shared_jit)
+        jit_pool->release(shared_jit);
+}
+
+bool DynarmicCPU::use_shared_jit() const {
+    // the shared JITs are created without any logging
+    return jit_pool && !log_code && !log_mem;
 }
 
-DynarmicCPU::~DynarmicCPU() = default;
+void DynarmicCPU::update_own_jit() {
+    const CPUContext current_ctx = save_context();
+    jit = nullptr;
+    own_jit.reset();
+    if (!use_shared_jit()) {
+        own_jit = make_jit(cb.get(), cp15, core_id);
+        jit = own_jit.get();
+    }
+    load_context(current_ctx);
+}
+
+void DynarmicCPU::acquire_jit() {
+    if (jit)
+        return;
+
+    shared_jit = jit_pool->acquire(*this, last_shared_jit);
+    if (shared_jit) {
+        last_shared_jit = shared_jit;
+        jit = shared_jit->jit.get();
+    } else {
+        LOG_WARN_ONCE("All the shared JITs are in use, some threads will use their own JIT");
+        own_jit = make_jit(cb.get(), cp15, core_id);
+        jit = own_jit.get();
+    }
+    load_context(saved_ctx);
+}
+
+void DynarmicCPU::release_jit() {
+    if (!shared_jit)
+        return;
+
+    saved_ctx = save_context();
+    jit = nullptr;
+    jit_pool->release(shared_jit);
+    shared_jit = nullptr;
+
+    // logging may have been enabled while the thread was running
+    if (!use_shared_jit())
+        update_own_jit();
+}
 
 int DynarmicCPU::run() {
     halted = false;
     break_ = false;
     exit_request = false;
     parent->svc_called = false;
+    acquire_jit();
     jit->Run();
+    release_jit();
     return halted;
 }
 
 int DynarmicCPU::step() {
     parent->svc_called = false;
+    acquire_jit();
     jit->Step();
+    release_jit();
     return 0;
 }
 
@@ -359,7 +475,8 @@ void DynarmicCPU::set_log_code(bool log) {
         return;
 
     log_code = log;
-    jit = make_jit();
+    if (!shared_jit)
+        update_own_jit();
 }
 
 void DynarmicCPU::set_log_mem(bool log) {
@@ -367,7 +484,8 @@ void DynarmicCPU::set_log_mem(bool log) {
         return;
 
     log_mem = log;
-    jit = make_jit();
+    if (!shared_jit)
+        update_own_jit();
 }
 
 bool DynarmicCPU::get_log_code() {
@@ -383,23 +501,29 @@ void DynarmicCPU::stop() {
 }
 
 uint32_t DynarmicCPU::get_reg(uint8_t idx) {
-    return jit->Regs()[idx];
+    return jit ? jit->Regs()[idx] : saved_ctx.cpu_registers[idx];
 }
 
 uint32_t DynarmicCPU::get_sp() {
-    return jit->Regs()[13];
+    return get_reg(13);
 }
 
 uint32_t DynarmicCPU::get_pc() {
-    return jit->Regs()[15];
+    return get_reg(15);
 }
 
 void DynarmicCPU::set_reg(uint8_t idx, uint32_t val) {
-    jit->Regs()[idx] = val;
+    if (jit)
+        jit->Regs()[idx] = val;
+    else
+        saved_ctx.cpu_registers[idx] = val;
 }
 
 void DynarmicCPU::set_cpsr(uint32_t val) {
-    jit->SetCpsr(val);
+    if (jit)
+        jit->SetCpsr(val);
+    else
+        saved_ctx.cpsr = val;
 }
 
 uint32_t DynarmicCPU::get_tpidruro() {
@@ -408,6 +532,8 @@ uint32_t DynarmicCPU::get_tpidruro() {
 
 void DynarmicCPU::set_tpidruro(uint32_t val) {
     cp15->set_tpidruro(val);
+    if (shared_jit)
+        shared_jit->cp15->set_tpidruro(val);
 }
 
 void DynarmicCPU::set_pc(uint32_t val) {
@@ -418,30 +544,36 @@ void DynarmicCPU::set_pc(uint32_t val) {
         set_cpsr(get_cpsr() & 0xFFFFFFDF);
         val = val & 0xFFFFFFFC;
     }
-    jit->Regs()[15] = val;
+    set_reg(15, val);
 }
 
 void DynarmicCPU::set_lr(uint32_t val) {
-    jit->Regs()[14] = val;
+    set_reg(14, val);
 }
 
 void DynarmicCPU::set_sp(uint32_t val) {
-    jit->Regs()[13] = val;
+    set_reg(13, val);
 }
 
 uint32_t DynarmicCPU::get_cpsr() {
-    return jit->Cpsr();
+    return jit ? jit->Cpsr() : saved_ctx.cpsr;
 }
 
 uint32_t DynarmicCPU::get_fpscr() {
-    return jit->Fpscr();
+    return jit ? jit->Fpscr() : saved_ctx.fpscr;
 }
 
 void DynarmicCPU::set_fpscr(uint32_t val) {
-    jit->SetFpscr(val);
+    if (jit)
+        jit->SetFpscr(val);
+    else
+        saved_ctx.fpscr = val;
 }
 
 CPUContext DynarmicCPU::save_context() {
+    if (!jit)
+        return saved_ctx;
+
     CPUContext ctx;
     ctx.cpu_registers = jit->Regs();
     static_assert(sizeof(ctx.fpu_registers) == sizeof(jit->ExtRegs()));
@@ -453,6 +585,11 @@ CPUContext DynarmicCPU::save_context() {
 }
 
 void DynarmicCPU::load_context(const CPUContext &ctx) {
+    if (!jit) {
+        saved_ctx = ctx;
+        return;
+    }
+
     jit->Regs() = ctx.cpu_registers;
     static_assert(sizeof(ctx.fpu_registers) == sizeof(jit->ExtRegs()));
     memcpy(jit->ExtRegs().data(), ctx.fpu_registers.data(), sizeof(ctx.fpu_registers));
@@ -461,27 +598,39 @@ void DynarmicCPU::load_context(const CPUContext &ctx) {
 }
 
 uint32_t DynarmicCPU::get_lr() {
-    return jit->Regs()[14];
+    return get_reg(14);
 }
 
 float DynarmicCPU::get_float_reg(uint8_t idx) {
-    return std::bit_cast<float>(jit->ExtRegs()[idx]);
+    return jit ? std::bit_cast<float>(jit->ExtRegs()[idx]) : saved_ctx.fpu_registers[idx];
 }
 
 void DynarmicCPU::set_float_reg(uint8_t idx, float val) {
-    jit->ExtRegs()[idx] = std::bit_cast<uint32_t>(val);
+    if (jit)
+        jit->ExtRegs()[idx] = std::bit_cast<uint32_t>(val);
+    else
+        saved_ctx.fpu_registers[idx] = val;
 }
 
 bool DynarmicCPU::is_thumb_mode() {
-    return jit->Cpsr() & 0x20;
+    return get_cpsr() & 0x20;
 }
 
 std::size_t DynarmicCPU::processor_id() const {
     return core_id;
 }
 
+void DynarmicCPU::clear_exclusive() {
+    // a thread running on a shared JIT uses the monitor slot of that JIT, not its own
+    if (jit)
+        jit->ClearExclusiveState();
+    monitor->ClearProcessor(shared_jit ? shared_jit->core_id : core_id);
+}
+
 void DynarmicCPU::invalidate_jit_cache(Address start, size_t length) {
-    jit->InvalidateCacheRange(start, length);
+    // the shared JITs are invalidated once for all the threads with invalidate_jit_pool
+    if (own_jit)
+        own_jit->InvalidateCacheRange(start, length);
 }
 
 // TODO: proper abstraction
@@ -498,3 +647,11 @@ void clear_exclusive(ExclusiveMonitorPtr monitor, std::size_t core_num) {
     Dynarmic::ExclusiveMonitor *monitor_ = static_cast<Dynarmic::ExclusiveMonitor *>(monitor);
     monitor_->ClearProcessor(core_num);
 }
+
+JitPoolPtr new_jit_pool(ExclusiveMonitorPtr monitor, std::size_t first_core_id, std::size_t max_count) {
+    return std::make_shared<DynarmicJitPool>(static_cast<Dynarmic::ExclusiveMonitor *>(monitor), first_core_id, max_count);
+}
+
+void invalidate_jit_pool(const JitPoolPtr &pool, Address start, size_t length) {
+    std::static_pointer_cast<DynarmicJitPool>(pool)->invalidate_jit_cache(start, length);
+}
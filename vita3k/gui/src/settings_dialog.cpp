@@ -1160,6 +1160,19 @@ void draw_settings_dialog(GuiState &gui, EmuEnvState &emuenv) {
             emuenv.kernel.debugger.watch_import_calls = !emuenv.kernel.debugger.watch_import_calls;
             emuenv.kernel.debugger.update_watches();
         }
+        ImportProfiler &import_profiler = emuenv.kernel.debugger.import_profiler;
+        if (ImGui::Button(import_profiler.is_enabled() ? lang.debug["stop_profiling_import_calls"].c_str() : lang.debug["profile_import_calls"].c_str())) {
+            if (import_profiler.is_enabled())
+                import_profiler.log_stats(20);
+            else
+                import_profiler.reset();
+            import_profiler.set_enabled(!import_profiler.is_enabled());
+        }
+        SetTooltipEx(lang.debug["profile_import_calls_description"].c_str());
+        ImGui::SameLine();
+        if (ImGui::Button(lang.debug["export_import_calls_profile"].c_str()))
+            import_profiler.export_collapsed_stacks(emuenv.kernel, emuenv.log_path / "hle_profile.folded");
+        SetTooltipEx(lang.debug["export_import_calls_profile_description"].c_str());
 
 #ifdef TRACY_ENABLE
         // Tracy profiler settings
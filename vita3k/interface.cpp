@@ -213,6 +213,7 @@ static bool install_archive_content(EmuEnvState &emuenv, GuiState *gui, const Zi
     }
     if (!copy_path(output_path, emuenv.pref_path, emuenv.app_info.app_title_id, emuenv.app_info.app_category))
         return false;
+    build_path_index(emuenv.io, emuenv.pref_path, emuenv.app_info.app_title_id, emuenv.app_info.app_category);
 
     update_progress();
 
@@ -350,6 +351,7 @@ static bool install_content(EmuEnvState &emuenv, GuiState *gui, const fs::path &
 
     if (!copy_path(dst_path, emuenv.pref_path, emuenv.app_info.app_title_id, emuenv.app_info.app_category))
         return false;
+    build_path_index(emuenv.io, emuenv.pref_path, emuenv.app_info.app_title_id, emuenv.app_info.app_category);
 
     LOG_INFO("{} [{}] installed successfully!", emuenv.app_info.app_title, emuenv.app_info.app_title_id);
 
@@ -387,10 +389,12 @@ static ExitCode load_app_impl(SceUID &main_module_id, EmuEnvState &emuenv) {
     const auto call_import = [&emuenv](CPUState &cpu, uint32_t nid, SceUID thread_id) {
         ::call_import(emuenv, cpu, nid, thread_id);
     };
+    emuenv.kernel.shared_jit = emuenv.cfg.shared_jit;
     if (!emuenv.kernel.init(emuenv.mem, call_import, emuenv.kernel.cpu_backend, emuenv.kernel.cpu_opt)) {
         LOG_WARN("Failed to init kernel!");
         return KernelInitFailed;
     }
+    emuenv.kernel.relocation_cache_path = emuenv.cache_path / "reloc" / emuenv.io.title_id;
 
     if (emuenv.cfg.archive_log) {
         const fs::path log_directory{ emuenv.log_path / "logs" };
@@ -403,6 +407,7 @@ static ExitCode load_app_impl(SceUID &main_module_id, EmuEnvState &emuenv) {
 
     LOG_INFO("{}: {}", emuenv.cfg[e_cpu_backend], emuenv.cfg.current_config.cpu_backend);
     LOG_INFO_IF(emuenv.kernel.cpu_backend == CPUBackend::Dynarmic, "CPU Optimisation state: {}", emuenv.cfg.current_config.cpu_opt);
+    LOG_INFO_IF(emuenv.kernel.cpu_backend == CPUBackend::Dynarmic, "Shared JIT state: {}", emuenv.kernel.shared_jit);
     LOG_INFO("ngs state: {}", emuenv.cfg.current_config.ngs_enable);
     LOG_INFO("Resolution multiplier: {}", emuenv.cfg.resolution_multiplier);
     if (emuenv.ctrl.controllers_num) {
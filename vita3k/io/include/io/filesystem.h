@@ -18,6 +18,7 @@
 #pragma once
 
 #include <util/fs.h>
+#include <util/mapped_file.h>
 
 #ifdef _WIN32
 #include <util/string_utils.h>
@@ -0,0 +1,87 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <io/psarc.h>
+#include <io/state.h>
+
+#include <util/fs.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+// File handle of SceFios2, reading either a host file or an entry of a mounted archive
+struct FiosFile {
+    // path after overlay resolution, also used to identify the blocks of the file in the cache
+    std::string path;
+    // descriptor in the io state of the host file, -1 for archive entries
+    SceUID fd = -1;
+    std::optional<FileStats> file;
+    std::shared_ptr<const PsarcArchive> archive;
+    PsarcArchive::Entry entry;
+    SceOff size = 0;
+    // position of sceFiosFHRead and sceFiosFHSeek, guarded by the mutex of the FIOS state
+    SceOff position = 0;
+    // set if an archive is mounted through this handle, it is unmounted when the handle is closed
+    std::optional<std::string> mount_point;
+};
+
+// Asynchronous operation of SceFios2, its id is a simple event which gets SCE_KERNEL_EVENT_IN once it is done
+struct FiosOp {
+    SceUID id = 0;
+    SceOff request_count = 0;
+    std::atomic<bool> done = false;
+    std::atomic<bool> cancelled = false;
+    // only valid once done is set
+    int error = 0;
+    SceOff actual_count = 0;
+};
+
+/**
+ * @brief Open a file through the overlays and the mounted archives
+ * @return The handle of the file or an SCE_ERROR_ERRNO error
+ */
+SceUID fios_open_file(IOState &io, const char *path, int flags, const fs::path &pref_path, const char *export_name);
+int fios_close_file(IOState &io, SceUID fh, const char *export_name);
+std::shared_ptr<FiosFile> fios_get_file(IOState &io, SceUID fh);
+
+// Read at the given offset, serving the data from the block cache when possible, return the number of bytes read or an error
+SceOff fios_read_file(IOState &io, const FiosFile &file, void *data, SceOff size, SceOff offset);
+// Load a range of the file in the block cache, a negative length meaning up to the end of the file
+int fios_prefetch_file(IOState &io, const FiosFile &file, SceOff offset, SceOff length);
+bool fios_cache_contains(IOState &io, const FiosFile &file, SceOff offset, SceOff length);
+// Drop a range of the file from the block cache, or the whole cache if file is null
+void fios_cache_flush(IOState &io, const FiosFile *file, SceOff offset = 0, SceOff length = -1);
+
+/**
+ * @brief Mount a PSARC archive, its entries are then opened by fios_open_file as files of the mount point
+ * @return The handle of the archive file, closing it unmounts the archive
+ */
+SceUID fios_mount_archive(IOState &io, const char *archive_path, const char *mount_point, const fs::path &pref_path, const char *export_name);
+// Size of the memory the archive needs once mounted, or an error
+int fios_get_archive_mount_size(IOState &io, const char *archive_path, const fs::path &pref_path, const char *export_name);
+// Return the previous thread count
+uint32_t fios_set_decompressor_thread_count(IOState &io, uint32_t thread_count);
+
+// Run an operation on the FIOS thread, after the operations queued before it
+void fios_run_async(IOState &io, std::function<void()> task);
+// Close all the handles, unmount the archives and empty the cache
+void fios_terminate(IOState &io, const char *export_name);
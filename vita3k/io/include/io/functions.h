@@ -27,6 +27,8 @@
 
 #include <util/fs.h>
 
+#include <functional>
+#include <optional>
 #include <string>
 
 struct IOState;
@@ -37,8 +39,14 @@ void init_device_paths(IOState &io);
 bool init_savedata_app_path(IOState &io, const fs::path &pref_path);
 bool init(IOState &io, const fs::path &cache_path, const fs::path &log_path, const fs::path &pref_path, bool redirect_stdio);
 
-bool find_case_isens_path(IOState &io, VitaIoDevice &device, const fs::path &translated_path, const fs::path &system_path);
-fs::path find_in_cache(IOState &io, const std::string &system_path);
+/**
+ * @brief Find a path of app0, addcont0 or vs0 ignoring its case
+ *
+ * @return The path with the case it has on the host filesystem, empty if it does not exist
+ */
+fs::path find_case_isens_path(IOState &io, VitaIoDevice device, const fs::path &translated_path, const fs::path &system_path);
+// Index the content just installed for a title, so that it does not have to be scanned on its first case-insensitive search
+void build_path_index(IOState &io, const fs::path &pref_path, const std::string &app_title_id, const std::string &app_category);
 
 fs::path expand_path(IOState &io, const char *path, const fs::path &pref_path);
 std::string translate_path(const char *path, VitaIoDevice &device, const IOState::DevicePaths &device_paths);
@@ -68,6 +76,18 @@ bool copy_path(const fs::path &src_path, const fs::path &pref_path, const std::s
 
 SceUID open_file(IOState &io, const char *path, const int flags, const fs::path &pref_path, const char *export_name);
 int read_file(void *data, IOState &io, SceUID fd, SceSize size, const char *export_name);
+int pread_file(void *data, IOState &io, SceUID fd, SceSize size, SceOff offset, const char *export_name);
+
+typedef std::function<void(SceOff result)> AsyncIoCallback;
+
+/**
+ * @brief Read a file on the asynchronous I/O threads
+ *
+ * @param offset Offset to read at without changing the file position, read at the current position if empty, which is moved past the data before queuing
+ * @param on_done Called from an I/O thread with the number of bytes read or a negative value on error
+ * @return 0 if the request was queued, an error otherwise (in which case on_done is not called)
+ */
+int read_file_async(void *data, IOState &io, SceUID fd, SceSize size, std::optional<SceOff> offset, AsyncIoCallback on_done, const char *export_name);
 int write_file(SceUID fd, const void *data, SceSize size, const IOState &io, const char *export_name);
 int truncate_file(SceUID fd, unsigned long long length, const IOState &io, const char *export_name);
 SceOff seek_file(SceUID fd, SceOff offset, SceIoSeekMode whence, IOState &io, const char *export_name);
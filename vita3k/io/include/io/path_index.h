@@ -0,0 +1,69 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \brief Case-insensitive index of the paths under a directory.
+ *
+ * The entries are sorted by the hash of their lowercase path, so a lookup is a hash of the path followed by a binary
+ * search. The paths are stored in a single string, which keeps the index compact enough to be saved and loaded as is.
+ */
+class PathIndex {
+public:
+    // Index the content of root, return nullptr if it does not exist
+    static std::unique_ptr<PathIndex> build(const fs::path &root, bool recursive);
+    // Return nullptr if the file does not exist or is not a valid index
+    static std::unique_ptr<PathIndex> load(const fs::path &index_path);
+    bool save(const fs::path &index_path) const;
+
+    /**
+     * \brief Find a path ignoring its case.
+     * \param relative_path Path relative to the root, separated by '/'
+     * \return The path with the case it has on the host filesystem
+     */
+    std::optional<std::string_view> find(std::string_view relative_path) const;
+
+    /**
+     * \brief Check if a path missing from the index may have been created since it was built.
+     * \param root Directory the index was built from
+     * \param relative_path Path relative to the root, separated by '/'
+     * \return true if the directory the path would be created in was modified after the index was built
+     */
+    bool may_be_outdated(const fs::path &root, std::string_view relative_path) const;
+
+private:
+    struct Entry {
+        uint64_t hash;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    std::vector<Entry> entries;
+    std::string paths;
+    std::time_t build_time = 0;
+};
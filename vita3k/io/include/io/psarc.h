@@ -0,0 +1,84 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <io/state.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Read-only view of a PSARC archive, as mounted by sceFiosArchiveMount.
+ *
+ * Files are split in blocks of a fixed uncompressed size which are compressed independently, so any
+ * block can be decompressed on its own and several blocks can be decompressed in parallel.
+ */
+class PsarcArchive {
+public:
+    struct Entry {
+        // index of the first block in the block size table
+        uint32_t first_block = 0;
+        uint64_t size = 0;
+        uint64_t offset = 0;
+    };
+
+    // Parse the header and the table of content, return nullptr if the file is not a supported archive
+    static std::unique_ptr<PsarcArchive> open(const FileStats &file);
+
+    // Path relative to the root of the archive, separated by '/'
+    const Entry *find(const std::string &path) const;
+
+    uint32_t get_block_size() const {
+        return block_size;
+    }
+
+    uint32_t get_block_count(const Entry &entry) const {
+        return static_cast<uint32_t>((entry.size + block_size - 1) / block_size);
+    }
+
+    // Size of the header and table of content, which is what the archive keeps in memory once mounted
+    uint32_t get_toc_size() const {
+        return toc_size;
+    }
+
+    /**
+     * \brief Decompress one block of an entry.
+     * \param out Resized to the uncompressed size of the block
+     * \return False if the block could not be read or decompressed
+     */
+    bool read_block(const Entry &entry, uint32_t index, std::vector<uint8_t> &out) const;
+
+private:
+    explicit PsarcArchive(const FileStats &file)
+        : file(file) {}
+
+    std::string normalize(const std::string &path) const;
+
+    FileStats file;
+    uint32_t block_size = 0;
+    uint32_t toc_size = 0;
+    bool ignore_case = false;
+    // compressed size of each block, 0 meaning a full uncompressed block
+    std::vector<uint32_t> block_sizes;
+    // offset in the archive of each block
+    std::vector<uint64_t> block_offsets;
+    std::map<std::string, Entry> entries;
+};
@@ -18,22 +18,35 @@
 #pragma once
 
 #include <io/filesystem.h>
+#include <io/path_index.h>
 #include <io/types.h>
 #include <io/util.h>
 
+#include <util/thread_pool.h>
+
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 // Class for all needed information to access files on Vita3K.
 class FileStats : public VitaStats {
     // Shared file pointer
     FilePtr wrapped_file;
+    // Set instead of the file pointer when the file content is mapped
+    MappedFilePtr mapped_file;
 
 public:
     // Constructor used for files
     // Based on https://codereview.stackexchange.com/questions/4679/
-    explicit FileStats(const char *vita, const std::string &t, const fs::path &file, const int open) {
-        wrapped_file = create_shared_file(file, open);
+    explicit FileStats(const char *vita, const std::string &t, const fs::path &file, const int open, const bool map_content = false) {
+        // reading a mapped file is a single copy from the page cache to the destination
+        if (map_content && !can_write(open))
+            mapped_file = map_file(file);
+        if (!mapped_file)
+            wrapped_file = create_shared_file(file, open);
 
         file_info.vita_loc = vita;
         file_info.translated = t;
@@ -62,6 +75,10 @@ public:
 
     // File functions
     SceOff read(void *input_data, int element_size, SceSize element_count) const;
+    // read at the given offset without changing the file position
+    SceOff pread(void *data, SceSize size, SceOff offset) const;
+    // move the file position past the next size bytes like a read would, return the position before it
+    SceOff advance(SceSize size) const;
     SceOff write(const void *data, SceSize size, int count) const;
     int truncate(const SceSize size) const;
     bool seek(SceOff offset, SceIoSeekMode seek_mode) const;
@@ -94,6 +111,48 @@ public:
     }
 };
 
+class PsarcArchive;
+struct FiosFile;
+struct FiosOp;
+
+// RAM cache of the blocks of files read through SceFios2, filled by the prefetch requests and by archive decompression
+struct FiosBlockCache {
+    typedef std::pair<std::string, uint64_t> Key;
+    typedef std::shared_ptr<const std::vector<uint8_t>> Data;
+
+    struct Block {
+        Data data;
+        std::list<Key>::iterator lru_it;
+    };
+
+    std::mutex mutex;
+    size_t capacity = 32 * 1024 * 1024;
+    size_t size = 0;
+    // the key is the resolved path of the file and the index of the block in it
+    std::map<Key, Block> blocks;
+    // least recently used first
+    std::list<Key> lru;
+};
+
+struct FiosState {
+    std::mutex mutex;
+    bool initialized = false;
+
+    SceUID next_fh = 1;
+    std::map<SceUID, std::shared_ptr<FiosFile>> files;
+    std::map<SceUID, std::shared_ptr<FiosOp>> ops;
+    // mounted archives by mount point
+    std::map<std::string, std::shared_ptr<const PsarcArchive>> archives;
+
+    FiosBlockCache cache;
+
+    // thread running the asynchronous operations, created on first use
+    std::unique_ptr<util::ThreadPool> op_pool;
+    uint32_t decompressor_thread_count = 2;
+    // shared so that the reads in progress keep their pool when the thread count changes
+    std::shared_ptr<util::ThreadPool> decompressor_pool;
+};
+
 typedef std::map<SceUID, TtyType> TtyFiles;
 typedef std::map<SceUID, FileStats> StdFiles;
 typedef std::map<SceUID, DirStats> DirEntries;
@@ -121,11 +180,21 @@ struct IOState {
     StdFiles std_files;
     DirEntries dir_entries;
 
-    std::unordered_map<std::string, std::string> cachemap;
     bool case_isens_find_enabled = false;
+    // where the indexes used by the case-insensitive search are saved
+    fs::path path_index_path;
+    std::mutex path_index_mutex;
+    // indexes of the directories searched case-insensitively, by directory
+    std::unordered_map<std::string, std::shared_ptr<const PathIndex>> path_indexes;
+
+    // threads executing the asynchronous requests, created on first use
+    std::mutex async_mutex;
+    std::unique_ptr<util::ThreadPool> async_pool;
 
     std::mutex overlay_mutex;
     SceUID next_overlay_id = 1;
     // overlay in the order they should be applied
     std::vector<FiosOverlay> overlays;
+
+    FiosState fios;
 };
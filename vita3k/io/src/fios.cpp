@@ -0,0 +1,386 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <io/fios.h>
+#include <io/functions.h>
+#include <io/io.h>
+
+#include <util/log.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+// granularity of the cache for host files, archive entries use the block size of the archive
+constexpr uint32_t FIOS_CACHE_BLOCK_SIZE = 64 * 1024;
+
+static uint32_t get_block_size(const FiosFile &file) {
+    return file.archive ? file.archive->get_block_size() : FIOS_CACHE_BLOCK_SIZE;
+}
+
+static std::shared_ptr<util::ThreadPool> get_decompressor_pool(FiosState &fios) {
+    const std::lock_guard<std::mutex> guard(fios.mutex);
+    if (!fios.decompressor_pool)
+        fios.decompressor_pool = std::make_shared<util::ThreadPool>(fios.decompressor_thread_count);
+
+    return fios.decompressor_pool;
+}
+
+static FiosBlockCache::Data cache_find(FiosBlockCache &cache, const FiosBlockCache::Key &key) {
+    const auto it = cache.blocks.find(key);
+    if (it == cache.blocks.end())
+        return nullptr;
+
+    cache.lru.splice(cache.lru.end(), cache.lru, it->second.lru_it);
+    return it->second.data;
+}
+
+static void cache_insert(FiosBlockCache &cache, const FiosBlockCache::Key &key, const FiosBlockCache::Data &data) {
+    if (cache.blocks.contains(key))
+        return;
+
+    const auto lru_it = cache.lru.insert(cache.lru.end(), key);
+    cache.blocks.emplace(key, FiosBlockCache::Block{ data, lru_it });
+    cache.size += data->size();
+
+    while (cache.size > cache.capacity && cache.lru.size() > 1) {
+        const auto evicted = cache.blocks.find(cache.lru.front());
+        cache.size -= evicted->second.data->size();
+        cache.blocks.erase(evicted);
+        cache.lru.pop_front();
+    }
+}
+
+static bool load_block(const FiosFile &file, const uint64_t index, std::vector<uint8_t> &out) {
+    if (file.archive)
+        return file.archive->read_block(file.entry, static_cast<uint32_t>(index), out);
+
+    const SceOff offset = static_cast<SceOff>(index) * FIOS_CACHE_BLOCK_SIZE;
+    const auto size = static_cast<SceSize>(std::min<SceOff>(FIOS_CACHE_BLOCK_SIZE, file.size - offset));
+    out.resize(size);
+    return file.file->pread(out.data(), size, offset) == size;
+}
+
+/**
+ * \brief Look up the blocks [first, first + blocks.size()) in the cache and load the missing ones.
+ *
+ * The blocks of archives are decompressed in parallel on the decompressor threads.
+ * \return False if a block could not be loaded
+ */
+static bool load_blocks(IOState &io, const FiosFile &file, const uint64_t first, std::vector<FiosBlockCache::Data> &blocks) {
+    std::vector<uint64_t> missing;
+    {
+        const std::lock_guard<std::mutex> guard(io.fios.cache.mutex);
+        for (uint64_t i = 0; i < blocks.size(); i++) {
+            blocks[i] = cache_find(io.fios.cache, { file.path, first + i });
+            if (!blocks[i])
+                missing.push_back(i);
+        }
+    }
+
+    if (missing.empty())
+        return true;
+
+    std::vector<std::vector<uint8_t>> loaded(missing.size());
+    std::vector<uint8_t> success(missing.size(), false);
+    const auto load = [&](uint32_t i) {
+        success[i] = load_block(file, first + missing[i], loaded[i]);
+    };
+    if (file.archive && missing.size() > 1)
+        get_decompressor_pool(io.fios)->parallel_for(static_cast<uint32_t>(missing.size()), load);
+    else {
+        for (uint32_t i = 0; i < missing.size(); i++)
+            load(i);
+    }
+
+    if (std::find(success.begin(), success.end(), false) != success.end())
+        return false;
+
+    const std::lock_guard<std::mutex> guard(io.fios.cache.mutex);
+    for (size_t i = 0; i < missing.size(); i++) {
+        blocks[missing[i]] = std::make_shared<const std::vector<uint8_t>>(std::move(loaded[i]));
+        cache_insert(io.fios.cache, { file.path, first + missing[i] }, blocks[missing[i]]);
+    }
+
+    return true;
+}
+
+SceUID fios_open_file(IOState &io, const char *path, const int flags, const fs::path &pref_path, const char *export_name) {
+    auto file = std::make_shared<FiosFile>();
+    file->path = resolve_path(io, path);
+
+    {
+        // the entries of a mounted archive hide the files of the mount point
+        const std::lock_guard<std::mutex> guard(io.fios.mutex);
+        for (const auto &[mount_point, archive] : io.fios.archives) {
+            if (file->path.size() <= mount_point.size() || !file->path.starts_with(mount_point) || file->path[mount_point.size()] != '/')
+                continue;
+
+            const PsarcArchive::Entry *entry = archive->find(file->path.substr(mount_point.size()));
+            if (!entry)
+                continue;
+
+            if (can_write(flags))
+                return SCE_ERROR_ERRNO_EROFS;
+
+            file->archive = archive;
+            file->entry = *entry;
+            file->size = static_cast<SceOff>(entry->size);
+            break;
+        }
+    }
+
+    if (!file->archive) {
+        const SceUID fd = open_file(io, file->path.c_str(), flags, pref_path, export_name);
+        if (fd < 0)
+            return fd;
+
+        const auto std_file = io.std_files.find(fd);
+        if (std_file == io.std_files.end()) {
+            // terminals and directories can not be read through FIOS
+            close_file(io, fd, export_name);
+            return SCE_ERROR_ERRNO_EBADFD;
+        }
+
+        file->fd = fd;
+        file->file = std_file->second;
+        boost::system::error_code ec;
+        file->size = static_cast<SceOff>(fs::file_size(file->file->get_system_location(), ec));
+        if (ec)
+            file->size = 0;
+    }
+
+    const std::lock_guard<std::mutex> guard(io.fios.mutex);
+    const SceUID fh = io.fios.next_fh++;
+    io.fios.files.emplace(fh, std::move(file));
+    return fh;
+}
+
+int fios_close_file(IOState &io, const SceUID fh, const char *export_name) {
+    std::shared_ptr<FiosFile> file;
+    {
+        const std::lock_guard<std::mutex> guard(io.fios.mutex);
+        const auto it = io.fios.files.find(fh);
+        if (it == io.fios.files.end())
+            return SCE_ERROR_ERRNO_EBADFD;
+
+        file = std::move(it->second);
+        io.fios.files.erase(it);
+        if (file->mount_point)
+            io.fios.archives.erase(*file->mount_point);
+    }
+
+    // the reads still in progress keep the host file alive through their copy of the handle
+    if (file->fd >= 0)
+        return close_file(io, file->fd, export_name);
+
+    return 0;
+}
+
+std::shared_ptr<FiosFile> fios_get_file(IOState &io, const SceUID fh) {
+    const std::lock_guard<std::mutex> guard(io.fios.mutex);
+    const auto it = io.fios.files.find(fh);
+    return it == io.fios.files.end() ? nullptr : it->second;
+}
+
+SceOff fios_read_file(IOState &io, const FiosFile &file, void *data, SceOff size, const SceOff offset) {
+    assert(data != nullptr);
+    assert(offset >= 0 && size >= 0);
+
+    if (offset >= file.size || size == 0)
+        return 0;
+
+    size = std::min(size, file.size - offset);
+    const uint32_t block_size = get_block_size(file);
+    const uint64_t first = offset / block_size;
+    const uint64_t last = (offset + size - 1) / block_size;
+    std::vector<FiosBlockCache::Data> blocks(last - first + 1);
+
+    if (file.archive) {
+        if (!load_blocks(io, file, first, blocks))
+            return SCE_ERROR_ERRNO_EIO;
+    } else {
+        // host files are only cached when prefetched, a read which is not fully cached goes to the file
+        // as splitting it would not be faster than the single pread or copy from the mapped file
+        const std::lock_guard<std::mutex> guard(io.fios.cache.mutex);
+        for (uint64_t i = 0; i < blocks.size(); i++) {
+            blocks[i] = cache_find(io.fios.cache, { file.path, first + i });
+            if (!blocks[i]) {
+                blocks.clear();
+                break;
+            }
+        }
+    }
+
+    if (blocks.empty())
+        return file.file->pread(data, static_cast<SceSize>(size), offset);
+
+    auto dst = static_cast<uint8_t *>(data);
+    SceOff position = offset;
+    for (const auto &block : blocks) {
+        const SceOff block_offset = position % block_size;
+        const auto count = std::min<SceOff>(static_cast<SceOff>(block->size()) - block_offset, offset + size - position);
+        memcpy(dst, block->data() + block_offset, count);
+        dst += count;
+        position += count;
+    }
+
+    return size;
+}
+
+int fios_prefetch_file(IOState &io, const FiosFile &file, const SceOff offset, SceOff length) {
+    assert(offset >= 0);
+
+    if (length < 0 || length > file.size - offset)
+        length = file.size - offset;
+    if (length <= 0)
+        return 0;
+
+    const uint32_t block_size = get_block_size(file);
+    const uint64_t first = offset / block_size;
+    const uint64_t last = (offset + length - 1) / block_size;
+    // the blocks past the capacity of the cache would evict the first ones as soon as they are inserted
+    const uint64_t max_count = std::max<uint64_t>(io.fios.cache.capacity / block_size, 1);
+    std::vector<FiosBlockCache::Data> blocks(std::min(last - first + 1, max_count));
+    return load_blocks(io, file, first, blocks) ? 0 : SCE_ERROR_ERRNO_EIO;
+}
+
+bool fios_cache_contains(IOState &io, const FiosFile &file, const SceOff offset, SceOff length) {
+    if (length < 0 || length > file.size - offset)
+        length = file.size - offset;
+    if (offset < 0 || length <= 0)
+        return false;
+
+    const uint32_t block_size = get_block_size(file);
+    const std::lock_guard<std::mutex> guard(io.fios.cache.mutex);
+    for (uint64_t block = offset / block_size; block <= static_cast<uint64_t>(offset + length - 1) / block_size; block++) {
+        if (!io.fios.cache.blocks.contains({ file.path, block }))
+            return false;
+    }
+
+    return true;
+}
+
+void fios_cache_flush(IOState &io, const FiosFile *file, const SceOff offset, SceOff length) {
+    FiosBlockCache &cache = io.fios.cache;
+    const std::lock_guard<std::mutex> guard(cache.mutex);
+    if (!file) {
+        cache.blocks.clear();
+        cache.lru.clear();
+        cache.size = 0;
+        return;
+    }
+
+    if (length < 0 || length > file->size - offset)
+        length = file->size - offset;
+    if (offset < 0 || length <= 0)
+        return;
+
+    const uint32_t block_size = get_block_size(*file);
+    const auto begin = cache.blocks.lower_bound({ file->path, offset / block_size });
+    const auto end = cache.blocks.upper_bound({ file->path, (offset + length - 1) / block_size });
+    for (auto it = begin; it != end;) {
+        cache.size -= it->second.data->size();
+        cache.lru.erase(it->second.lru_it);
+        it = cache.blocks.erase(it);
+    }
+}
+
+SceUID fios_mount_archive(IOState &io, const char *archive_path, const char *mount_point, const fs::path &pref_path, const char *export_name) {
+    std::string point = mount_point;
+    while (!point.empty() && point.back() == '/')
+        point.pop_back();
+
+    const SceUID fh = fios_open_file(io, archive_path, SCE_O_RDONLY, pref_path, export_name);
+    if (fh < 0)
+        return fh;
+
+    const std::shared_ptr<FiosFile> file = fios_get_file(io, fh);
+    std::shared_ptr<const PsarcArchive> archive;
+    // archives inside other archives are not supported
+    if (file->file)
+        archive = PsarcArchive::open(*file->file);
+    if (!archive) {
+        LOG_ERROR("{}: {} is not a supported archive", export_name, archive_path);
+        fios_close_file(io, fh, export_name);
+        return SCE_ERROR_ERRNO_EOPNOTSUPP;
+    }
+
+    const std::lock_guard<std::mutex> guard(io.fios.mutex);
+    if (io.fios.archives.contains(point)) {
+        LOG_ERROR("{}: An archive is already mounted at {}", export_name, point);
+        io.fios.files.erase(fh);
+        close_file(io, file->fd, export_name);
+        return SCE_ERROR_ERRNO_EEXIST;
+    }
+
+    LOG_INFO("{}: Mounting archive {} at {}", export_name, file->path, point);
+    file->mount_point = point;
+    io.fios.archives.emplace(std::move(point), std::move(archive));
+    return fh;
+}
+
+int fios_get_archive_mount_size(IOState &io, const char *archive_path, const fs::path &pref_path, const char *export_name) {
+    const SceUID fh = fios_open_file(io, archive_path, SCE_O_RDONLY, pref_path, export_name);
+    if (fh < 0)
+        return fh;
+
+    const std::shared_ptr<FiosFile> file = fios_get_file(io, fh);
+    const std::unique_ptr<PsarcArchive> archive = file->file ? PsarcArchive::open(*file->file) : nullptr;
+    fios_close_file(io, fh, export_name);
+    if (!archive)
+        return SCE_ERROR_ERRNO_EOPNOTSUPP;
+
+    return static_cast<int>(archive->get_toc_size());
+}
+
+uint32_t fios_set_decompressor_thread_count(IOState &io, const uint32_t thread_count) {
+    const std::lock_guard<std::mutex> guard(io.fios.mutex);
+    const uint32_t previous = io.fios.decompressor_thread_count;
+    if (thread_count != previous) {
+        io.fios.decompressor_thread_count = std::max(thread_count, 1U);
+        // the new pool is created on the next decompression
+        io.fios.decompressor_pool.reset();
+    }
+
+    return previous;
+}
+
+void fios_run_async(IOState &io, std::function<void()> task) {
+    {
+        const std::lock_guard<std::mutex> guard(io.fios.mutex);
+        // a single thread, so that the operations complete in the order they were issued
+        if (!io.fios.op_pool)
+            io.fios.op_pool = std::make_unique<util::ThreadPool>(1);
+    }
+
+    io.fios.op_pool->push(std::move(task));
+}
+
+void fios_terminate(IOState &io, const char *export_name) {
+    std::vector<SceUID> handles;
+    {
+        const std::lock_guard<std::mutex> guard(io.fios.mutex);
+        for (const auto &[fh, file] : io.fios.files)
+            handles.push_back(fh);
+    }
+
+    for (const SceUID fh : handles)
+        fios_close_file(io, fh, export_name);
+
+    fios_cache_flush(io, nullptr);
+}
@@ -116,6 +116,7 @@ bool init(IOState &io, const fs::path &cache_path, const fs::path &log_path, con
     fs::create_directory(log_path / "texturelog");
 
     io.redirect_stdio = redirect_stdio;
+    io.path_index_path = cache_path / "path_index";
 
 #ifndef _WIN32
     io.case_isens_find_enabled = true;
@@ -142,49 +143,96 @@ bool init_savedata_app_path(IOState &io, const fs::path &pref_path) {
     return true;
 }
 
-bool find_case_isens_path(IOState &io, VitaIoDevice &device, const fs::path &translated_path, const fs::path &system_path) {
-    std::string final_path{};
+// The indexes of installed content are saved, the directories of vs0 are small and only indexed in memory
+static fs::path get_saved_index_path(const IOState &io, const fs::path &root) {
+    return io.path_index_path / (root.parent_path().filename().string() + "_" + root.filename().string() + ".bin");
+}
+
+static std::shared_ptr<const PathIndex> get_path_index(IOState &io, const fs::path &root, const bool saved, const bool rebuild) {
+    const std::lock_guard<std::mutex> guard(io.path_index_mutex);
+    auto &index = io.path_indexes[root.string()];
+    if (index && !rebuild)
+        return index;
+
+    index = nullptr;
+    if (saved && !rebuild)
+        index = PathIndex::load(get_saved_index_path(io, root));
+    if (!index) {
+        std::unique_ptr<PathIndex> built = PathIndex::build(root, saved);
+        if (built && saved)
+            built->save(get_saved_index_path(io, root));
+        index = std::move(built);
+    }
+
+    return index;
+}
+
+void build_path_index(IOState &io, const fs::path &pref_path, const std::string &app_title_id, const std::string &app_category) {
+    if (!io.case_isens_find_enabled)
+        return;
+
+    if (app_category.starts_with("gd") || app_category.starts_with("gp"))
+        get_path_index(io, pref_path / "ux0/app" / app_title_id, true, true);
+    else if (app_category == "ac")
+        get_path_index(io, pref_path / "ux0/addcont" / app_title_id, true, true);
+}
+
+fs::path find_case_isens_path(IOState &io, const VitaIoDevice device, const fs::path &translated_path, const fs::path &system_path) {
+    std::string root;
+    bool saved = true;
 
     switch (device) {
     case +VitaIoDevice::app0: {
         std::string app_id = translated_path.string().substr(0, 14);
-        final_path = system_path.string().substr(0, system_path.string().find(app_id)) + app_id;
+        root = system_path.string().substr(0, system_path.string().find(app_id)) + app_id;
         break;
     }
     case +VitaIoDevice::addcont0: {
         std::string addcont_id = translated_path.string().substr(0, 18);
-        final_path = system_path.string().substr(0, system_path.string().find(addcont_id)) + addcont_id;
+        root = system_path.string().substr(0, system_path.string().find(addcont_id)) + addcont_id;
         break;
     }
     case +VitaIoDevice::vs0: {
         // This only works if ALL the parent folders of the path are the correct case or are in a case insensitive fs
         // Only the file's name is searched for, not the parent folders
-        final_path = system_path.string().substr(0, system_path.string().find_last_of('/'));
+        root = fs::path(system_path).remove_trailing_separator().parent_path().string();
+        saved = false;
         break;
     }
     default: {
-        return false;
+        return {};
     }
     }
 
-    if (!fs::exists(final_path))
-        return false;
+    while (!root.empty() && root.back() == '/')
+        root.pop_back();
 
-    for (const auto &file : fs::recursive_directory_iterator(final_path)) {
-        io.cachemap.emplace(string_utils::tolower(file.path().string()), file.path().string());
-    }
+    std::string relative_path = fs::path(system_path).remove_trailing_separator().generic_string();
+    if (relative_path.size() <= root.size() || !relative_path.starts_with(root))
+        return {};
+    relative_path.erase(0, root.size() + 1);
 
-    return true;
-}
+    for (const bool rebuild : { false, true }) {
+        const auto index = get_path_index(io, root, saved, rebuild);
+        if (!index)
+            return {};
 
-fs::path find_in_cache(IOState &io, const std::string &system_path) {
-    const auto find_path = io.cachemap.find(system_path);
+        // the index is rebuilt once when it is out of date: a path found was removed since it was built,
+        // or a path missing was maybe created in a directory modified since then
+        // games often look for files which don't exist, rebuilding on every miss would walk the whole directory each time
+        const auto found = index->find(relative_path);
+        if (!found) {
+            if (!index->may_be_outdated(root, relative_path))
+                return {};
+            continue;
+        }
 
-    if (find_path != io.cachemap.end()) {
-        return fs::path{ find_path->second.c_str() };
-    } else {
-        return fs::path{};
+        const fs::path found_path = fs::path(root) / fs::path(std::string(*found));
+        if (fs::exists(found_path))
+            return found_path;
     }
+
+    return {};
 }
 
 std::string translate_path(const char *path, VitaIoDevice &device, const IOState::DevicePaths &device_paths) {
@@ -318,20 +366,13 @@ SceUID open_file(IOState &io, const char *path, const int flags, const fs::path
         if (!(flags & SCE_O_CREAT)) {
             if (io.case_isens_find_enabled) {
                 // Attempt a case-insensitive file search.
-                const auto original_system_path = system_path;
-                const auto cached_path = find_in_cache(io, string_utils::tolower(system_path.string()));
-                if (!cached_path.empty()) {
-                    system_path = cached_path;
-                    LOG_TRACE("Found cached filepath at {}", system_path);
+                const auto found_path = find_case_isens_path(io, device_for_icase, translated_path, system_path);
+                if (!found_path.empty()) {
+                    LOG_TRACE("Found file on case-sensitive filesystem at {}", found_path);
+                    system_path = found_path;
                 } else {
-                    const bool path_found = find_case_isens_path(io, device_for_icase, translated_path, system_path);
-                    system_path = find_in_cache(io, string_utils::tolower(system_path.string()));
-                    if (!system_path.empty() && path_found) {
-                        LOG_TRACE("Found file on case-sensitive filesystem at {}", system_path);
-                    } else {
-                        LOG_ERROR("Missing file at {} (target path: {})", original_system_path, path);
-                        return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
-                    }
+                    LOG_ERROR("Missing file at {} (target path: {})", system_path, path);
+                    return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
                 }
             } else {
                 LOG_ERROR("Missing file at {} (target path: {})", system_path, path);
@@ -347,7 +388,9 @@ SceUID open_file(IOState &io, const char *path, const int flags, const fs::path
 
     const auto normalized_path = device::construct_normalized_path(device, translated_path);
 
-    FileStats f{ path, normalized_path, system_path, flags };
+    // the content of these devices does not change while the app is running
+    const bool map_content = device == VitaIoDevice::app0 || device == VitaIoDevice::vs0 || device == VitaIoDevice::addcont0;
+    FileStats f{ path, normalized_path, system_path, flags, map_content };
     const auto fd = io.next_fd++;
     io.std_files.emplace(fd, f);
 
@@ -379,6 +422,53 @@ int read_file(void *data, IOState &io, const SceUID fd, const SceSize size, cons
     return IO_ERROR(SCE_ERROR_ERRNO_EBADFD);
 }
 
+int pread_file(void *data, IOState &io, const SceUID fd, const SceSize size, const SceOff offset, const char *export_name) {
+    assert(data != nullptr);
+    assert(offset >= 0);
+
+    const auto file = io.std_files.find(fd);
+    if (file == io.std_files.end())
+        return IO_ERROR(SCE_ERROR_ERRNO_EBADFD);
+
+    const auto read = file->second.pread(data, size, offset);
+    LOG_TRACE_IF(log_file_op && log_file_read, "{}: Reading {} bytes of fd {} at offset {}", export_name, read, log_hex(fd), log_hex(offset));
+    return static_cast<int>(read);
+}
+
+static util::ThreadPool &get_async_pool(IOState &io) {
+    // the requests mostly wait for the disk, a few threads are enough to overlap them
+    constexpr uint32_t async_thread_count = 2;
+
+    const std::lock_guard<std::mutex> guard(io.async_mutex);
+    if (!io.async_pool)
+        io.async_pool = std::make_unique<util::ThreadPool>(async_thread_count);
+
+    return *io.async_pool;
+}
+
+int read_file_async(void *data, IOState &io, const SceUID fd, const SceSize size, const std::optional<SceOff> offset, AsyncIoCallback on_done, const char *export_name) {
+    assert(data != nullptr);
+    assert(!offset || *offset >= 0);
+
+    const auto file = io.std_files.find(fd);
+    if (file == io.std_files.end())
+        return IO_ERROR(SCE_ERROR_ERRNO_EBADFD);
+
+    // the position is taken and moved now, so the requests on the same fd read consecutive data whichever thread runs them
+    const SceOff position = offset ? *offset : file->second.advance(size);
+    if (position < 0)
+        return IO_ERROR_UNK();
+
+    LOG_TRACE_IF(log_file_op && log_file_read, "{}: Queuing read of {} bytes of fd {} at offset {}", export_name, size, log_hex(fd), log_hex(position));
+
+    // the copy shares the host file with the fd, so the request still completes if the fd is closed meanwhile
+    get_async_pool(io).push([file = file->second, data, size, position, on_done = std::move(on_done)]() {
+        on_done(file.pread(data, size, position));
+    });
+
+    return 0;
+}
+
 int write_file(SceUID fd, const void *data, const SceSize size, const IOState &io, const char *export_name) {
     assert(data != nullptr);
     assert(size >= 0);
@@ -496,20 +586,13 @@ int stat_file(IOState &io, const char *file, SceIoStat *statp, const fs::path &p
         if (!fs::exists(file_path)) {
             if (io.case_isens_find_enabled) {
                 // Attempt a case-insensitive file search.
-                const auto original_file_path = file_path;
-                const auto cached_path = find_in_cache(io, string_utils::tolower(file_path.string()));
-                if (!cached_path.empty()) {
-                    file_path = cached_path;
-                    LOG_TRACE("Found cached filepath at {}", file_path);
+                const auto found_path = find_case_isens_path(io, device_for_icase, translated_path, file_path);
+                if (!found_path.empty()) {
+                    LOG_TRACE("Found file on case-sensitive filesystem at {}", found_path);
+                    file_path = found_path;
                 } else {
-                    const bool path_found = find_case_isens_path(io, device_for_icase, translated_path, file_path);
-                    file_path = find_in_cache(io, string_utils::tolower(file_path.string()));
-                    if (!file_path.empty() && path_found) {
-                        LOG_TRACE("Found file on case-sensitive filesystem at {}", file_path);
-                    } else {
-                        LOG_ERROR("Missing file at {} (target path: {})", original_file_path, file);
-                        return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
-                    }
+                    LOG_ERROR("Missing file at {} (target path: {})", file_path, file);
+                    return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
                 }
             } else {
                 LOG_ERROR("Missing file at {} (target path: {})", file_path, file);
@@ -677,20 +760,13 @@ SceUID open_dir(IOState &io, const char *path, const fs::path &pref_path, const
     if (!fs::exists(dir_path)) {
         if (io.case_isens_find_enabled) {
             // Attempt a case-insensitive file search.
-            const auto original_dir_path = dir_path;
-            const auto cached_path = find_in_cache(io, string_utils::tolower(dir_path.string()));
-            if (!cached_path.empty()) {
-                dir_path = cached_path;
-                LOG_TRACE("Found cached directory path at {}", dir_path);
+            const auto found_path = find_case_isens_path(io, device_for_icase, translated_path, dir_path);
+            if (!found_path.empty()) {
+                LOG_TRACE("Found directory on case-sensitive filesystem at {}", found_path);
+                dir_path = found_path / "";
             } else {
-                const bool path_found = find_case_isens_path(io, device_for_icase, translated_path, dir_path);
-                dir_path = find_in_cache(io, string_utils::tolower(dir_path.string().substr(0, dir_path.string().size() - 1)));
-                if (!dir_path.empty() && path_found) {
-                    LOG_TRACE("Found directory on case-sensitive filesystem at {}", dir_path);
-                } else {
-                    LOG_ERROR("Directory does not exist at {} (target path: {})", original_dir_path, path);
-                    return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
-                }
+                LOG_ERROR("Directory does not exist at {} (target path: {})", dir_path, path);
+                return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
             }
         } else {
             LOG_ERROR("Directory does not exist at: {} (target path: {})", dir_path, path);
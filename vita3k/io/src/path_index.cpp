@@ -0,0 +1,155 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <io/path_index.h>
+
+#include <util/log.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+constexpr char PATH_INDEX_MAGIC[8] = { 'V', '3', 'K', 'P', 'A', 'T', 'H', 'S' };
+constexpr uint32_t PATH_INDEX_VERSION = 2;
+
+struct PathIndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t paths_size;
+    int64_t build_time;
+};
+
+static char to_lower(const char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+// FNV-1a of the lowercase path
+static uint64_t hash_path(const std::string_view path) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const char c : path) {
+        hash ^= static_cast<uint8_t>(to_lower(c));
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+std::unique_ptr<PathIndex> PathIndex::build(const fs::path &root, const bool recursive) {
+    boost::system::error_code ec;
+    if (!fs::is_directory(root, ec))
+        return nullptr;
+
+    std::unique_ptr<PathIndex> index(new PathIndex());
+    // taken before listing the directories, so the entries created while they are listed are seen as new
+    index->build_time = std::time(nullptr);
+    const auto add = [&](const fs::path &path) {
+        const std::string relative = path.lexically_relative(root).generic_string();
+        index->entries.push_back({ hash_path(relative), static_cast<uint32_t>(index->paths.size()), static_cast<uint32_t>(relative.size()) });
+        index->paths += relative;
+    };
+
+    if (recursive) {
+        for (const auto &file : fs::recursive_directory_iterator(root, ec))
+            add(file.path());
+    } else {
+        for (const auto &file : fs::directory_iterator(root, ec))
+            add(file.path());
+    }
+
+    std::sort(index->entries.begin(), index->entries.end(), [](const Entry &a, const Entry &b) {
+        return a.hash < b.hash;
+    });
+    LOG_INFO("Indexed {} paths in {}", index->entries.size(), root);
+    return index;
+}
+
+std::unique_ptr<PathIndex> PathIndex::load(const fs::path &index_path) {
+    fs::ifstream file(index_path, std::ios::binary);
+    if (!file)
+        return nullptr;
+
+    PathIndexHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) || memcmp(header.magic, PATH_INDEX_MAGIC, sizeof(PATH_INDEX_MAGIC)) != 0
+        || header.version != PATH_INDEX_VERSION)
+        return nullptr;
+
+    std::unique_ptr<PathIndex> index(new PathIndex());
+    index->entries.resize(header.entry_count);
+    index->paths.resize(header.paths_size);
+    index->build_time = static_cast<std::time_t>(header.build_time);
+    if (!file.read(reinterpret_cast<char *>(index->entries.data()), index->entries.size() * sizeof(Entry))
+        || !file.read(index->paths.data(), index->paths.size()))
+        return nullptr;
+
+    for (const Entry &entry : index->entries) {
+        if (static_cast<uint64_t>(entry.offset) + entry.size > index->paths.size())
+            return nullptr;
+    }
+
+    return index;
+}
+
+bool PathIndex::save(const fs::path &index_path) const {
+    fs::create_directories(index_path.parent_path());
+    fs::ofstream file(index_path, std::ios::binary);
+    if (!file)
+        return false;
+
+    PathIndexHeader header{};
+    memcpy(header.magic, PATH_INDEX_MAGIC, sizeof(PATH_INDEX_MAGIC));
+    header.version = PATH_INDEX_VERSION;
+    header.entry_count = static_cast<uint32_t>(entries.size());
+    header.paths_size = static_cast<uint32_t>(paths.size());
+    header.build_time = static_cast<int64_t>(build_time);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(Entry));
+    file.write(paths.data(), paths.size());
+
+    return static_cast<bool>(file);
+}
+
+std::optional<std::string_view> PathIndex::find(const std::string_view relative_path) const {
+    const uint64_t hash = hash_path(relative_path);
+    const auto [begin, end] = std::equal_range(entries.begin(), entries.end(), Entry{ hash, 0, 0 }, [](const Entry &a, const Entry &b) {
+        return a.hash < b.hash;
+    });
+
+    // several paths can share a hash, so the candidates are compared
+    for (auto it = begin; it != end; ++it) {
+        const std::string_view path(paths.data() + it->offset, it->size);
+        if (std::equal(path.begin(), path.end(), relative_path.begin(), relative_path.end(), [](const char a, const char b) { return to_lower(a) == to_lower(b); }))
+            return path;
+    }
+
+    return std::nullopt;
+}
+
+bool PathIndex::may_be_outdated(const fs::path &root, const std::string_view relative_path) const {
+    // creating an entry only changes the modification time of its parent, look for the deepest one already indexed
+    fs::path parent = root;
+    for (size_t pos = relative_path.find('/'); pos != std::string_view::npos; pos = relative_path.find('/', pos + 1)) {
+        const auto found = find(relative_path.substr(0, pos));
+        if (!found)
+            break;
+        parent = root / fs::path(std::string(*found));
+    }
+
+    // the times are in seconds, a directory modified in the same second as the build may have been modified after it
+    boost::system::error_code ec;
+    const std::time_t modified = fs::last_write_time(parent, ec);
+    return ec || modified >= build_time;
+}
@@ -0,0 +1,180 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <io/psarc.h>
+
+#include <util/log.h>
+
+#include <miniz.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+constexpr uint32_t PSARC_MAGIC = 0x50534152; // PSAR
+constexpr uint32_t PSARC_HEADER_SIZE = 0x20;
+constexpr uint32_t PSARC_FLAG_IGNORE_CASE = 1;
+
+// all the integers of the archive are stored in big endian
+static uint64_t read_be(const uint8_t *data, uint32_t size) {
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < size; i++)
+        value = (value << 8) | data[i];
+    return value;
+}
+
+std::unique_ptr<PsarcArchive> PsarcArchive::open(const FileStats &file) {
+    uint8_t header[PSARC_HEADER_SIZE];
+    if (file.pread(header, sizeof(header), 0) != sizeof(header) || read_be(header, 4) != PSARC_MAGIC)
+        return nullptr;
+
+    if (memcmp(header + 8, "zlib", 4) != 0) {
+        LOG_ERROR("Unsupported PSARC compression {}", std::string(reinterpret_cast<const char *>(header + 8), 4));
+        return nullptr;
+    }
+
+    std::unique_ptr<PsarcArchive> archive(new PsarcArchive(file));
+    archive->toc_size = static_cast<uint32_t>(read_be(header + 12, 4));
+    const auto toc_entry_size = static_cast<uint32_t>(read_be(header + 16, 4));
+    const auto toc_entry_count = static_cast<uint32_t>(read_be(header + 20, 4));
+    archive->block_size = static_cast<uint32_t>(read_be(header + 24, 4));
+    archive->ignore_case = read_be(header + 28, 4) & PSARC_FLAG_IGNORE_CASE;
+
+    const uint64_t entries_end = PSARC_HEADER_SIZE + static_cast<uint64_t>(toc_entry_size) * toc_entry_count;
+    if (toc_entry_size < 30 || toc_entry_count == 0 || archive->block_size == 0 || entries_end > archive->toc_size)
+        return nullptr;
+
+    std::vector<uint8_t> toc(archive->toc_size - PSARC_HEADER_SIZE);
+    if (file.pread(toc.data(), static_cast<SceSize>(toc.size()), PSARC_HEADER_SIZE) != static_cast<SceOff>(toc.size()))
+        return nullptr;
+
+    // the width of the block sizes depends on how many bytes are needed to store the block size
+    uint32_t size_width = 4;
+    if (archive->block_size <= 0x10000)
+        size_width = 2;
+    else if (archive->block_size <= 0x1000000)
+        size_width = 3;
+
+    const uint8_t *block_table = toc.data() + (entries_end - PSARC_HEADER_SIZE);
+    const size_t block_count = (archive->toc_size - entries_end) / size_width;
+    archive->block_sizes.resize(block_count);
+    for (size_t i = 0; i < block_count; i++)
+        archive->block_sizes[i] = static_cast<uint32_t>(read_be(block_table + i * size_width, size_width));
+
+    std::vector<Entry> toc_entries(toc_entry_count);
+    archive->block_offsets.resize(block_count);
+    for (uint32_t i = 0; i < toc_entry_count; i++) {
+        const uint8_t *toc_entry = toc.data() + i * toc_entry_size;
+        Entry &entry = toc_entries[i];
+        // the entry starts with the md5 of its path
+        entry.first_block = static_cast<uint32_t>(read_be(toc_entry + 16, 4));
+        entry.size = read_be(toc_entry + 20, 5);
+        entry.offset = read_be(toc_entry + 25, 5);
+
+        const uint32_t entry_block_count = archive->get_block_count(entry);
+        if (static_cast<uint64_t>(entry.first_block) + entry_block_count > block_count) {
+            LOG_ERROR("PSARC entry {} is out of the block table", i);
+            return nullptr;
+        }
+
+        // the blocks of an entry are stored one after the other
+        uint64_t block_offset = entry.offset;
+        for (uint32_t block = entry.first_block; block < entry.first_block + entry_block_count; block++) {
+            archive->block_offsets[block] = block_offset;
+            block_offset += archive->block_sizes[block] ? archive->block_sizes[block] : archive->block_size;
+        }
+    }
+
+    // the first entry is the manifest, with the paths of the other entries separated by new lines
+    const Entry &manifest = toc_entries[0];
+    std::string paths;
+    std::vector<uint8_t> block;
+    for (uint32_t i = 0; i < archive->get_block_count(manifest); i++) {
+        if (!archive->read_block(manifest, i, block))
+            return nullptr;
+        paths.append(block.begin(), block.end());
+    }
+
+    size_t start = 0;
+    for (uint32_t i = 1; i < toc_entry_count && start <= paths.size(); i++) {
+        size_t end = paths.find('\n', start);
+        if (end == std::string::npos)
+            end = paths.size();
+
+        std::string path = paths.substr(start, end - start);
+        std::erase(path, '\0');
+        std::erase(path, '\r');
+        archive->entries.emplace(archive->normalize(path), toc_entries[i]);
+        start = end + 1;
+    }
+
+    return archive;
+}
+
+std::string PsarcArchive::normalize(const std::string &path) const {
+    std::string normalized = path;
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    // absolute and relative paths refer to the same entries
+    const size_t first = normalized.find_first_not_of('/');
+    normalized.erase(0, first == std::string::npos ? normalized.size() : first);
+
+    if (ignore_case)
+        std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    return normalized;
+}
+
+const PsarcArchive::Entry *PsarcArchive::find(const std::string &path) const {
+    const auto it = entries.find(normalize(path));
+    return it == entries.end() ? nullptr : &it->second;
+}
+
+bool PsarcArchive::read_block(const Entry &entry, uint32_t index, std::vector<uint8_t> &out) const {
+    if (index >= get_block_count(entry))
+        return false;
+
+    const uint32_t block = entry.first_block + index;
+    const uint32_t compressed_size = block_sizes[block] ? block_sizes[block] : block_size;
+    const auto uncompressed_size = static_cast<uint32_t>(std::min<uint64_t>(block_size, entry.size - static_cast<uint64_t>(index) * block_size));
+
+    std::vector<uint8_t> compressed(compressed_size);
+    if (file.pread(compressed.data(), compressed_size, static_cast<SceOff>(block_offsets[block])) != compressed_size)
+        return false;
+
+    // blocks which do not shrink are stored as is, the compressed ones start with a zlib header
+    const bool is_compressed = compressed_size >= 2 && compressed[0] == 0x78 && ((compressed[0] << 8) | compressed[1]) % 31 == 0;
+    const bool can_be_raw = compressed_size == uncompressed_size;
+    if (!is_compressed && can_be_raw) {
+        out = std::move(compressed);
+        return true;
+    }
+
+    out.resize(uncompressed_size);
+    mz_ulong dest_size = uncompressed_size;
+    const int res = mz_uncompress(out.data(), &dest_size, compressed.data(), compressed_size);
+    if ((res != MZ_OK || dest_size != uncompressed_size) && can_be_raw) {
+        // raw data which happens to look like a zlib header
+        out = std::move(compressed);
+        return true;
+    }
+    if (res != MZ_OK || dest_size != uncompressed_size) {
+        LOG_ERROR("Failed to decompress PSARC block {}: {}", block, mz_error(res));
+        return false;
+    }
+
+    return true;
+}
@@ -26,7 +26,27 @@
 
 #include <io/state.h>
 
+#include <algorithm>
+#include <cstring>
+
 SceOff FileStats::read(void *input_data, const int element_size, const SceSize element_count) const {
+    if (mapped_file) {
+        if (element_size <= 0)
+            return 0;
+
+        // take the range before copying it, so concurrent reads get consecutive data like with fread
+        int64_t position = mapped_file->position.load();
+        uint64_t count;
+        do {
+            const uint64_t remaining = static_cast<uint64_t>(position) < mapped_file->size ? mapped_file->size - position : 0;
+            // like fread, only read whole elements
+            count = std::min<uint64_t>(element_count, remaining / element_size);
+        } while (!mapped_file->position.compare_exchange_weak(position, position + count * element_size));
+
+        memcpy(input_data, mapped_file->data + position, count * element_size);
+        return count;
+    }
+
     if (!wrapped_file)
         return -1;
 
@@ -40,7 +60,72 @@ SceOff FileStats::write(const void *data, const SceSize size, const int count) c
     return fwrite(data, size, count, get_file_pointer());
 }
 
+SceOff FileStats::pread(void *data, const SceSize size, const SceOff offset) const {
+    if (offset < 0)
+        return -1;
+
+    if (mapped_file) {
+        const uint64_t position = static_cast<uint64_t>(offset);
+        const uint64_t count = position < mapped_file->size ? std::min<uint64_t>(size, mapped_file->size - position) : 0;
+        memcpy(data, mapped_file->data + position, count);
+        return count;
+    }
+
+    if (!wrapped_file)
+        return -1;
+
+    // the data written through the stream may still be in its buffer
+    if (can_write_file())
+        fflush(wrapped_file.get());
+
+#ifdef _WIN32
+    // ReadFile also moves the file pointer on synchronous handles, so restore the position of the stream instead
+    _lock_file(wrapped_file.get());
+    const SceOff position = _ftelli64_nolock(wrapped_file.get());
+    SceOff read = -1;
+    if (_fseeki64_nolock(wrapped_file.get(), offset, SEEK_SET) == 0) {
+        read = _fread_nolock(data, 1, size, wrapped_file.get());
+        _fseeki64_nolock(wrapped_file.get(), position, SEEK_SET);
+    }
+    _unlock_file(wrapped_file.get());
+    return read;
+#else
+    const int fd = fileno(wrapped_file.get());
+    SceOff total = 0;
+    while (total < size) {
+        const ssize_t read = ::pread(fd, static_cast<uint8_t *>(data) + total, size - total, offset + total);
+        if (read < 0)
+            return total > 0 ? total : -1;
+        if (read == 0)
+            break;
+        total += read;
+    }
+    return total;
+#endif
+}
+
+SceOff FileStats::advance(const SceSize size) const {
+    if (mapped_file) {
+        int64_t position = mapped_file->position.load();
+        while (!mapped_file->position.compare_exchange_weak(position, std::max<int64_t>(position, std::min<int64_t>(position + size, mapped_file->size)))) {
+        }
+        return position;
+    }
+
+    const SceOff position = tell();
+    if (position < 0 || !seek(0, SCE_SEEK_END))
+        return -1;
+
+    // a read stops at the end of the file, but does not move back a position already past it
+    const SceOff end = tell();
+    seek(std::max(position, std::min<SceOff>(position + size, end)), SCE_SEEK_SET);
+    return position;
+}
+
 int FileStats::truncate(const SceSize size) const {
+    if (!wrapped_file)
+        return -1;
+
 #ifdef _WIN32
     return _chsize_s(_fileno(get_file_pointer()), size);
 #else
@@ -49,6 +134,29 @@ int FileStats::truncate(const SceSize size) const {
 }
 
 bool FileStats::seek(const SceOff offset, const SceIoSeekMode seek_mode) const {
+    if (mapped_file) {
+        SceOff position = offset;
+        switch (seek_mode) {
+        case SCE_SEEK_SET:
+            break;
+        case SCE_SEEK_CUR:
+            position += mapped_file->position;
+            break;
+        case SCE_SEEK_END:
+            position += mapped_file->size;
+            break;
+        default:
+            return false;
+        }
+
+        // seeking past the end is allowed, the following reads return nothing
+        if (position < 0)
+            return false;
+
+        mapped_file->position = position;
+        return true;
+    }
+
     if (!wrapped_file)
         return false;
 
@@ -75,6 +183,9 @@ bool FileStats::seek(const SceOff offset, const SceIoSeekMode seek_mode) const {
 }
 
 SceOff FileStats::tell() const {
+    if (mapped_file)
+        return mapped_file->position;
+
     if (!wrapped_file)
         return -1;
 
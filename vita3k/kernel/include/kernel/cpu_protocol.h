@@ -30,6 +30,7 @@ struct CPUProtocol : public CPUProtocolBase {
     void call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState &thread) override;
     Address get_watch_memory_addr(Address addr) override;
     ExclusiveMonitorPtr get_exclusive_monitor() override;
+    JitPoolPtr get_jit_pool() override;
 
 private:
     CallImportFunc call_import;
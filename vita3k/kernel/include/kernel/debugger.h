@@ -17,6 +17,7 @@
 
 #pragma once
 #include <cpu/state.h>
+#include <kernel/import_profiler.h>
 #include <mem/state.h>
 #include <mem/util.h>
 
@@ -66,6 +67,8 @@ struct Debugger {
     bool log_exports = false;
     bool dump_elfs = false;
 
+    ImportProfiler import_profiler;
+
     void add_watch_memory_addr(Address addr, size_t size);
     void remove_watch_memory_addr(KernelState &state, Address addr);
     void add_breakpoint(MemState &mem, uint32_t addr, bool thumb_mode);
@@ -0,0 +1,96 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+typedef int SceUID;
+struct KernelState;
+
+struct ImportCallStats {
+    uint64_t count = 0;
+    // time spent in the call, including the guest callbacks and nested HLE calls it made
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    // last thread which made this call
+    SceUID thread_id = 0;
+};
+
+typedef std::unordered_map<uint32_t, ImportCallStats> ImportCallStatsMap;
+
+/**
+ * \brief Counters and timers of the HLE calls, indexed by NID
+ *
+ * Each host thread records its calls in its own table, so enabling the profiler does not add
+ * contention between the guest threads. While enabled, the most expensive calls are logged at a
+ * regular interval and the call stacks can be exported in the collapsed format used by flame graphs.
+ */
+class ImportProfiler {
+public:
+    void set_enabled(bool enabled);
+    bool is_enabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    void begin_call(uint32_t nid);
+    void end_call(uint32_t nid, SceUID thread_id);
+
+    // merge the tables of all the threads
+    ImportCallStatsMap get_stats();
+    void reset();
+    void log_stats(size_t max_entries);
+
+    /**
+     * \brief Write the recorded call stacks as "thread;nid;nid self_time_ns" lines.
+     * \return False if the file could not be written
+     */
+    bool export_collapsed_stacks(KernelState &kernel, const fs::path &path);
+
+private:
+    struct ThreadTable {
+        std::mutex mutex;
+        ImportCallStatsMap stats;
+        // self time of each call stack
+        std::map<std::vector<uint32_t>, uint64_t> stacks;
+        SceUID thread_id = 0;
+
+        // only accessed by the owning thread
+        struct Frame {
+            std::chrono::steady_clock::time_point start;
+            uint64_t children_ns = 0;
+        };
+        std::vector<uint32_t> call_stack;
+        std::vector<Frame> frames;
+    };
+
+    ThreadTable &get_thread_table();
+
+    std::atomic<bool> enabled = false;
+    std::atomic<int64_t> last_dump_ns = 0;
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadTable>> tables;
+};
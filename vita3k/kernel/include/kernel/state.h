@@ -28,6 +28,7 @@
 #include <mem/util.h>
 #include <rtc/rtc.h>
 #include <util/containers.h>
+#include <util/fs.h>
 #include <util/types.h>
 
 #include <atomic>
@@ -131,10 +132,14 @@ struct KernelState {
     ModuleUidByNid module_uid_by_nid;
 
     bool cpu_opt;
+    bool shared_jit = true;
     CPUBackend cpu_backend;
     CorenumAllocator corenum_allocator;
     CPUProtocolPtr cpu_protocol;
     ExclusiveMonitorPtr exclusive_monitor;
+    JitPoolPtr jit_pool;
+    // folder of the module images saved after relocation, empty to always relocate
+    fs::path relocation_cache_path;
 
     ObjectStore obj_store;
 
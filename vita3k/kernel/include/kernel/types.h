@@ -59,6 +59,7 @@
 #define SCE_KERNEL_MUTEX_ATTR_RECURSIVE 0x2U
 #define SCE_KERNEL_MUTEX_ATTR_CEILING 0x4U
 
+#define SCE_KERNEL_EVENT_IN 0x00000001U
 #define SCE_KERNEL_EVENT_TIMER 0x00008000U
 
 #define SCE_KERNEL_MSG_PIPE_MODE_ASAP 0x00000000U
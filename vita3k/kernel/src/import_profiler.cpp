@@ -0,0 +1,177 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/import_profiler.h>
+
+#include <kernel/state.h>
+#include <kernel/thread/thread_state.h>
+#include <nids/functions.h>
+#include <util/log.h>
+
+#include <algorithm>
+
+// interval between two logs of the most expensive calls
+static constexpr std::chrono::seconds DUMP_INTERVAL(10);
+static constexpr size_t DUMP_MAX_ENTRIES = 20;
+
+void ImportProfiler::set_enabled(bool enabled) {
+    if (enabled && !this->enabled)
+        last_dump_ns = std::chrono::steady_clock::now().time_since_epoch().count();
+    this->enabled = enabled;
+}
+
+ImportProfiler::ThreadTable &ImportProfiler::get_thread_table() {
+    struct ThreadTableRef {
+        ImportProfiler *owner = nullptr;
+        std::shared_ptr<ThreadTable> table;
+    };
+    thread_local ThreadTableRef ref;
+
+    if (ref.owner != this) {
+        ref.owner = this;
+        ref.table = std::make_shared<ThreadTable>();
+        const std::lock_guard<std::mutex> guard(mutex);
+        tables.push_back(ref.table);
+    }
+    return *ref.table;
+}
+
+void ImportProfiler::begin_call(uint32_t nid) {
+    ThreadTable &table = get_thread_table();
+    table.call_stack.push_back(nid);
+    table.frames.push_back({ std::chrono::steady_clock::now() });
+}
+
+void ImportProfiler::end_call(uint32_t nid, SceUID thread_id) {
+    const auto now = std::chrono::steady_clock::now();
+    ThreadTable &table = get_thread_table();
+    if (table.frames.empty() || table.call_stack.back() != nid)
+        return;
+
+    const ThreadTable::Frame frame = table.frames.back();
+    const uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame.start).count();
+    const uint64_t self_ns = elapsed_ns - std::min(elapsed_ns, frame.children_ns);
+
+    {
+        const std::lock_guard<std::mutex> guard(table.mutex);
+        table.thread_id = thread_id;
+        ImportCallStats &stats = table.stats[nid];
+        stats.count++;
+        stats.total_ns += elapsed_ns;
+        stats.max_ns = std::max(stats.max_ns, elapsed_ns);
+        stats.thread_id = thread_id;
+        table.stacks[table.call_stack] += self_ns;
+    }
+
+    table.call_stack.pop_back();
+    table.frames.pop_back();
+    if (!table.frames.empty())
+        table.frames.back().children_ns += elapsed_ns;
+
+    // periodic dump, done by the first thread noticing the interval has elapsed
+    const int64_t now_ns = now.time_since_epoch().count();
+    int64_t last_ns = last_dump_ns.load(std::memory_order_relaxed);
+    if (now_ns - last_ns >= std::chrono::nanoseconds(DUMP_INTERVAL).count()
+        && last_dump_ns.compare_exchange_strong(last_ns, now_ns))
+        log_stats(DUMP_MAX_ENTRIES);
+}
+
+ImportCallStatsMap ImportProfiler::get_stats() {
+    std::vector<std::shared_ptr<ThreadTable>> tables_copy;
+    {
+        const std::lock_guard<std::mutex> guard(mutex);
+        tables_copy = tables;
+    }
+
+    ImportCallStatsMap result;
+    for (const auto &table : tables_copy) {
+        const std::lock_guard<std::mutex> guard(table->mutex);
+        for (const auto &[nid, stats] : table->stats) {
+            ImportCallStats &merged = result[nid];
+            merged.count += stats.count;
+            merged.total_ns += stats.total_ns;
+            if (stats.max_ns >= merged.max_ns) {
+                merged.max_ns = stats.max_ns;
+                merged.thread_id = stats.thread_id;
+            }
+        }
+    }
+
+    return result;
+}
+
+void ImportProfiler::reset() {
+    const std::lock_guard<std::mutex> guard(mutex);
+    for (const auto &table : tables) {
+        const std::lock_guard<std::mutex> table_guard(table->mutex);
+        table->stats.clear();
+        table->stacks.clear();
+    }
+}
+
+void ImportProfiler::log_stats(size_t max_entries) {
+    const ImportCallStatsMap stats = get_stats();
+    std::vector<std::pair<uint32_t, ImportCallStats>> sorted_stats(stats.begin(), stats.end());
+    std::sort(sorted_stats.begin(), sorted_stats.end(), [](const auto &a, const auto &b) {
+        return a.second.total_ns > b.second.total_ns;
+    });
+    if (sorted_stats.size() > max_entries)
+        sorted_stats.resize(max_entries);
+
+    LOG_INFO("HLE calls profile (top {} by total time):", sorted_stats.size());
+    for (const auto &[nid, call] : sorted_stats) {
+        LOG_INFO("  {} {:<48} count: {:<8} total: {:>10.3f} ms, avg: {:>8.3f} us, max: {:>8.3f} us (TID: {})",
+            log_hex(nid), import_name(nid), call.count, call.total_ns / 1e6, call.total_ns / 1e3 / call.count, call.max_ns / 1e3, call.thread_id);
+    }
+}
+
+bool ImportProfiler::export_collapsed_stacks(KernelState &kernel, const fs::path &path) {
+    std::vector<std::shared_ptr<ThreadTable>> tables_copy;
+    {
+        const std::lock_guard<std::mutex> guard(mutex);
+        tables_copy = tables;
+    }
+
+    fs::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR("Failed to open {} to export the HLE calls profile", path);
+        return false;
+    }
+
+    for (const auto &table : tables_copy) {
+        const std::lock_guard<std::mutex> guard(table->mutex);
+        if (table->stacks.empty())
+            continue;
+
+        std::string thread_name = fmt::format("TID:{}", table->thread_id);
+        if (const ThreadStatePtr thread = kernel.get_thread(table->thread_id))
+            thread_name = fmt::format("{} ({})", thread->name, table->thread_id);
+        // ';' and ' ' are separators in the collapsed format
+        std::replace(thread_name.begin(), thread_name.end(), ';', '_');
+
+        for (const auto &[stack, self_ns] : table->stacks) {
+            std::string line = thread_name;
+            for (const uint32_t nid : stack)
+                fmt::format_to(std::back_inserter(line), ";{}", import_name(nid));
+            fmt::format_to(std::back_inserter(line), " {}\n", self_ns);
+            file << line;
+        }
+    }
+
+    LOG_INFO("HLE calls profile exported to {}", path);
+    return true;
+}
@@ -86,7 +86,9 @@ bool KernelState::init(MemState &mem, const CallImportFunc &call_import, CPUBack
     constexpr std::size_t MAX_CORE_COUNT = 150;
 
     corenum_allocator.set_max_core_count(MAX_CORE_COUNT);
-    exclusive_monitor = new_exclusive_monitor(MAX_CORE_COUNT);
+    // the shared JITs use their own processor ids, after the ones given to the threads
+    exclusive_monitor = new_exclusive_monitor(MAX_CORE_COUNT * 2);
+    jit_pool = (cpu_backend == CPUBackend::Dynarmic && shared_jit) ? new_jit_pool(exclusive_monitor, MAX_CORE_COUNT, MAX_CORE_COUNT) : nullptr;
     start_tick = rtc_get_ticks(rtc_base_ticks());
     base_tick = { rtc_base_ticks() };
     cpu_protocol = std::make_unique<CPUProtocol>(*this, mem, call_import);
@@ -127,6 +129,8 @@ void KernelState::invalidate_jit_cache(Address start, size_t length) {
     for (const auto &[_, thread] : threads) {
         ::invalidate_jit_cache(*thread->cpu, start, length);
     }
+    if (jit_pool)
+        invalidate_jit_pool(jit_pool, start, length);
 }
 
 ThreadStatePtr KernelState::get_thread(SceUID thread_id) {
@@ -25,6 +25,7 @@
 #include <util/arm.h>
 #include <util/fs.h>
 #include <util/log.h>
+#include <util/thread_pool.h>
 
 #include <util/elf.h>
 // clang-format off
@@ -35,6 +36,9 @@
 #include <miniz.h>
 #include <self.h>
 
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
 #include <cassert>
 #include <cstring>
 #include <fstream>
@@ -469,6 +473,86 @@ static bool load_exports(SceKernelModuleInfo *kernel_module_info, const sce_modu
     return true;
 }
 
+// magic number put at the beginning of each relocation cache file
+constexpr uint32_t relocation_cache_magic = 0x434C4552;
+constexpr uint32_t relocation_cache_version = 2;
+
+struct RelocationCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t module_hash;
+    uint32_t segment_count;
+    uint32_t padding;
+};
+
+struct RelocationCacheSegment {
+    uint32_t index;
+    Address addr;
+    // number of bytes saved, at least p_filesz
+    uint32_t size;
+};
+
+// Relocations can also target the zero-filled tail of a segment (p_filesz to p_memsz), which is then saved up to its last non-zero byte
+static uint32_t get_relocated_size(const MemState &mem, const SegmentInfoForReloc &segment, const Elf32_Phdr &phdr) {
+    const uint8_t *const seg_ptr = Ptr<const uint8_t>(segment.addr).get(mem);
+    uint32_t size = phdr.p_memsz;
+    while (size > phdr.p_filesz && seg_ptr[size - 1] == 0)
+        size--;
+    return std::max(size, phdr.p_filesz);
+}
+
+/**
+ * \brief Load the segments of a module as they were after relocation in a previous session.
+ * \return False if the cache file is missing or does not match the module or the address of its segments
+ */
+static bool load_relocated_image(const fs::path &file_path, uint64_t module_hash, const SegmentInfosForReloc &segments, const Elf32_Phdr *phdrs, MemState &mem) {
+    fs::ifstream cache_file(file_path, std::ios::in | std::ios::binary);
+    if (!cache_file.is_open())
+        return false;
+
+    RelocationCacheHeader header{};
+    cache_file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!cache_file || header.magic != relocation_cache_magic || header.version != relocation_cache_version || header.module_hash != module_hash || header.segment_count != segments.size())
+        return false;
+
+    std::vector<RelocationCacheSegment> cached_segments(header.segment_count);
+    cache_file.read(reinterpret_cast<char *>(cached_segments.data()), cached_segments.size() * sizeof(RelocationCacheSegment));
+    if (!cache_file)
+        return false;
+
+    auto cached_segment = cached_segments.begin();
+    for (const auto &[seg_index, segment] : segments) {
+        if (cached_segment->index != seg_index || cached_segment->addr != segment.addr || cached_segment->size < phdrs[seg_index].p_filesz || cached_segment->size > phdrs[seg_index].p_memsz)
+            return false;
+        ++cached_segment;
+    }
+
+    for (const RelocationCacheSegment &segment : cached_segments)
+        cache_file.read(Ptr<char>(segment.addr).get(mem), segment.size);
+    if (!cache_file) {
+        LOG_WARN("Relocation cache file {} is corrupted, ignoring it.", file_path);
+        return false;
+    }
+
+    return true;
+}
+
+static void save_relocated_image(const fs::path &file_path, uint64_t module_hash, const SegmentInfosForReloc &segments, const Elf32_Phdr *phdrs, const MemState &mem) {
+    fs::create_directories(file_path.parent_path());
+    fs::ofstream cache_file(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!cache_file.is_open())
+        return;
+
+    const RelocationCacheHeader header{ relocation_cache_magic, relocation_cache_version, module_hash, static_cast<uint32_t>(segments.size()), 0 };
+    cache_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    std::vector<RelocationCacheSegment> cached_segments;
+    for (const auto &[seg_index, segment] : segments)
+        cached_segments.push_back({ seg_index, segment.addr, get_relocated_size(mem, segment, phdrs[seg_index]) });
+    cache_file.write(reinterpret_cast<const char *>(cached_segments.data()), cached_segments.size() * sizeof(RelocationCacheSegment));
+    for (const RelocationCacheSegment &segment : cached_segments)
+        cache_file.write(Ptr<const char>(segment.addr).get(mem), segment.size);
+}
+
 /**
  * \return Negative on failure
  */
@@ -568,6 +652,8 @@ SceUID load_self(KernelState &kernel, MemState &mem, const void *self, const std
     };
 
     SegmentInfosForReloc segment_reloc_info;
+    // relocation segments, applied once all the loadable segments are in memory
+    std::vector<Elf_Half> reloc_segments;
 
     auto free_all_segments = [](MemState &mem, SegmentInfosForReloc &segs_info) {
         for (auto &[_, segment] : segs_info) {
@@ -575,9 +661,9 @@ SceUID load_self(KernelState &kernel, MemState &mem, const void *self, const std
         }
     };
 
+    // Allocate the loadable segments first, their content is then inflated in parallel
     for (Elf_Half seg_index = 0; seg_index < elf.e_phnum; ++seg_index) {
         const Elf32_Phdr &seg_header = segments[seg_index];
-        const uint8_t *const seg_bytes = self_bytes + self_header.header_len + seg_header.p_offset;
 
         LOG_DEBUG_IF(LOG_MODULE_LOADING, "    [{}] (p_type: {}): p_offset: {}, p_vaddr: {}, p_paddr: {}, p_filesz: {}, p_memsz: {}, p_flags: {}, p_align: {}", get_seg_header_string(seg_header.p_type), log_hex(seg_header.p_type), log_hex(seg_header.p_offset), log_hex(seg_header.p_vaddr), log_hex(seg_header.p_paddr), log_hex(seg_header.p_filesz), log_hex(seg_header.p_memsz), log_hex(seg_header.p_flags), log_hex(seg_header.p_align));
 
@@ -624,50 +710,83 @@ SceUID load_self(KernelState &kernel, MemState &mem, const void *self, const std
                     return SCE_KERNEL_ERROR_NO_MEMORY; // TODO is this correct?
                 }
 
-                const Ptr<uint8_t> seg_ptr(segment_address);
+                segment_reloc_info[seg_index] = { segment_address, seg_header.p_vaddr, seg_header.p_memsz };
+            }
+        } else if (seg_header.p_type == PT_SCE_RELA) {
+            reloc_segments.push_back(seg_index);
+        } else if ((seg_header.p_type == PT_SCE_COMMENT) || (seg_header.p_type == PT_SCE_VERSION)
+            || (seg_header.p_type == PT_ARM_EXIDX) /* TODO: this may be important and require being loaded */) {
+            LOG_INFO("{}: Skipping special segment {}...", self_path, log_hex(seg_header.p_type));
+        } else {
+            LOG_CRITICAL("{}: Skipping segment with unknown p_type {}!", self_path, log_hex(seg_header.p_type));
+        }
+    }
+
+    // The relocated image only depends on the module, its patches and the address of its segments
+    uint64_t module_hash = XXH3_64bits(self_bytes, self_header.self_filesize);
+    for (const auto &patch : patches)
+        module_hash = XXH3_64bits_withSeed(patch.values.data(), patch.values.size(), module_hash ^ (static_cast<uint64_t>(patch.seg) << 32 | patch.offset));
+
+    fs::path reloc_cache_file;
+    if (!kernel.relocation_cache_path.empty() && !segment_reloc_info.empty())
+        reloc_cache_file = kernel.relocation_cache_path / fmt::format("{:016x}-{:08x}.dat", module_hash, segment_reloc_info.begin()->second.addr);
+
+    if (!reloc_cache_file.empty() && load_relocated_image(reloc_cache_file, module_hash, segment_reloc_info, segments, mem)) {
+        LOG_INFO("Loaded relocated segments of {} from the cache", self_path);
+    } else {
+        std::vector<Elf_Half> load_segments;
+        for (const auto &[seg_index, _] : segment_reloc_info)
+            load_segments.push_back(seg_index);
+        std::vector<std::unique_ptr<uint8_t[]>> reloc_buffers(reloc_segments.size());
+
+        // Each job only writes to its own segment or relocation buffer
+        util::get_worker_pool().parallel_for(static_cast<uint32_t>(load_segments.size() + reloc_segments.size()), [&](uint32_t job) {
+            if (job < load_segments.size()) {
+                const Elf_Half seg_index = load_segments[job];
+                const Elf32_Phdr &seg_header = segments[seg_index];
+                uint8_t *const seg_ptr = Ptr<uint8_t>(segment_reloc_info.at(seg_index).addr).get(mem);
                 if (seg_infos[seg_index].compression == 2) {
                     unsigned long dest_bytes = seg_header.p_filesz;
                     const uint8_t *const compressed_segment_bytes = self_bytes + seg_infos[seg_index].offset;
 
-                    int res = mz_uncompress(seg_ptr.get(mem), &dest_bytes, compressed_segment_bytes, static_cast<mz_ulong>(seg_infos[seg_index].length));
+                    int res = mz_uncompress(seg_ptr, &dest_bytes, compressed_segment_bytes, static_cast<mz_ulong>(seg_infos[seg_index].length));
                     assert(res == MZ_OK);
                 } else {
-                    memcpy(seg_ptr.get(mem), seg_bytes, seg_header.p_filesz);
+                    memcpy(seg_ptr, self_bytes + self_header.header_len + seg_header.p_offset, seg_header.p_filesz);
                 }
 
                 for (auto &patch : patches) {
                     // TODO patches should maybe be able to specify the path/file to patch?
                     if (seg_index == patch.seg && self_path.find("eboot.bin") != std::string::npos) {
                         LOG_INFO("Patching segment {} at offset 0x{:X} with {} values", seg_index, patch.offset, patch.values.size());
-                        memcpy(seg_ptr.get(mem) + patch.offset, patch.values.data(), patch.values.size());
+                        memcpy(seg_ptr + patch.offset, patch.values.data(), patch.values.size());
                     }
                 }
-
-                segment_reloc_info[seg_index] = { segment_address, seg_header.p_vaddr, seg_header.p_memsz };
-            }
-        } else if (seg_header.p_type == PT_SCE_RELA) {
-            if (seg_infos[seg_index].compression == 2) {
-                unsigned long dest_bytes = seg_header.p_filesz;
-                const uint8_t *const compressed_segment_bytes = self_bytes + seg_infos[seg_index].offset;
-                auto uncompressed = std::make_unique<uint8_t[]>(dest_bytes);
-
-                int res = mz_uncompress(uncompressed.get(), &dest_bytes, compressed_segment_bytes, static_cast<mz_ulong>(seg_infos[seg_index].length));
-                assert(res == MZ_OK);
-                if (!relocate(uncompressed.get(), seg_header.p_filesz, segment_reloc_info, mem)) {
-                    return -1;
-                }
-
             } else {
-                if (!relocate(seg_bytes, seg_header.p_filesz, segment_reloc_info, mem)) {
-                    return -1;
+                const size_t reloc_index = job - load_segments.size();
+                const Elf_Half seg_index = reloc_segments[reloc_index];
+                if (seg_infos[seg_index].compression == 2) {
+                    unsigned long dest_bytes = segments[seg_index].p_filesz;
+                    const uint8_t *const compressed_segment_bytes = self_bytes + seg_infos[seg_index].offset;
+                    reloc_buffers[reloc_index] = std::make_unique<uint8_t[]>(dest_bytes);
+
+                    int res = mz_uncompress(reloc_buffers[reloc_index].get(), &dest_bytes, compressed_segment_bytes, static_cast<mz_ulong>(seg_infos[seg_index].length));
+                    assert(res == MZ_OK);
                 }
             }
-        } else if ((seg_header.p_type == PT_SCE_COMMENT) || (seg_header.p_type == PT_SCE_VERSION)
-            || (seg_header.p_type == PT_ARM_EXIDX) /* TODO: this may be important and require being loaded */) {
-            LOG_INFO("{}: Skipping special segment {}...", self_path, log_hex(seg_header.p_type));
-        } else {
-            LOG_CRITICAL("{}: Skipping segment with unknown p_type {}!", self_path, log_hex(seg_header.p_type));
+        });
+
+        // Relocations are applied in the order of the program headers so the result does not depend on the scheduling
+        for (size_t i = 0; i < reloc_segments.size(); i++) {
+            const Elf32_Phdr &seg_header = segments[reloc_segments[i]];
+            const void *const entries = reloc_buffers[i] ? reloc_buffers[i].get() : self_bytes + self_header.header_len + seg_header.p_offset;
+            if (!relocate(entries, seg_header.p_filesz, segment_reloc_info, mem)) {
+                return -1;
+            }
         }
+
+        if (!reloc_cache_file.empty())
+            save_relocated_image(reloc_cache_file, module_hash, segment_reloc_info, segments, mem);
     }
 
     if (kernel.debugger.dump_elfs) {
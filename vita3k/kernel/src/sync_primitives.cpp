@@ -297,7 +297,7 @@ SceInt32 simple_event_delete(KernelState &kernel, const char *export_name, SceUI
 
     if (event->waiting_threads->empty()) {
         const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
-        kernel.eventflags.erase(event_id);
+        kernel.simple_events.erase(event_id);
     } else {
         // TODO:
         LOG_WARN("Can't delete sync object, it has waiting threads.");
@@ -725,7 +725,12 @@ struct LangState {
             { "unwatch_memory", "Unwatch Memory" },
             { "watch_memory", "Watch Memory" },
             { "unwatch_import_calls", "Unwatch Import Calls" },
-            { "watch_import_calls", "Watch Import Calls" }
+            { "watch_import_calls", "Watch Import Calls" },
+            { "stop_profiling_import_calls", "Stop Profiling Import Calls" },
+            { "profile_import_calls", "Profile Import Calls" },
+            { "profile_import_calls_description", "Measure the time spent in each HLE function and log the most expensive ones every 10 seconds." },
+            { "export_import_calls_profile", "Export Import Calls Profile" },
+            { "export_import_calls_profile_description", "Write the recorded call stacks to hle_profile.folded in the log folder, in the collapsed format used by flame graph tools." }
         };
     };
     SettingsDialog settings_dialog;
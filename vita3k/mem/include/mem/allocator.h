@@ -20,13 +20,26 @@
 #include <cstdint>
 #include <vector>
 
+// Bitmap of free slots (bit set when free), the most significant bit of a word being its first slot.
+// Two summary levels, one bit per word and one bit per summary entry, let the searches skip the fully allocated words.
 struct BitmapAllocator {
     std::vector<std::uint32_t> words;
     std::size_t max_offset;
 
 protected:
+    // Bit i set if words[i] may have a free slot. A stale bit is only a wasted lookup, so writing zeros to words
+    // directly keeps the allocator valid, freeing slots must go through free.
+    std::vector<std::uint64_t> word_summary;
+    // Bit i set if word_summary[i] is not zero
+    std::vector<std::uint64_t> group_summary;
+
     int force_fill(const std::uint32_t offset, const std::uint32_t size, const bool or_mode = false);
 
+    void update_summary(const std::size_t word_index);
+    void rebuild_summary();
+    // Index of the first word at or after word_index which may have a free slot, or words.size()
+    std::size_t next_free_word(const std::size_t word_index) const;
+
 public:
     BitmapAllocator() = default;
     explicit BitmapAllocator(const std::size_t total_bits);
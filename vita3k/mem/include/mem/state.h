@@ -21,9 +21,12 @@
 #include <mem/functions.h>
 #include <mem/util.h>
 
+#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 struct AllocMemPage {
     uint32_t allocated : 4;
@@ -38,25 +41,38 @@ typedef std::unique_ptr<AllocMemPage[]> AllocPageTable;
 typedef std::unique_ptr<PagePtr[]> PageTable;
 typedef std::map<int, std::string> PageNameMap;
 
+// Shared by the pieces of a protected block which covers several protect regions
+struct ProtectHandler {
+    ProtectCallback callback;
+    // Set once the callback accepted an access, the pieces left in the other regions are then dropped without calling it
+    std::atomic<bool> released = false;
+};
+
 struct ProtectBlockInfo {
+    Address addr = 0;
     uint32_t size = 0;
-    ProtectCallback callback;
+    std::shared_ptr<ProtectHandler> handler;
 };
 
 struct ProtectSegmentInfo {
-    std::multimap<Address, ProtectBlockInfo> blocks;
+    Address start = 0;
     uint32_t size = 0;
     int32_t ref_count = 0; // When reference count is active, we don't interfere protection.
     MemPerm perm = MemPerm::None;
+    // Sorted by address
+    std::vector<ProtectBlockInfo> blocks;
+};
 
-    explicit ProtectSegmentInfo() = default;
-    explicit ProtectSegmentInfo(uint32_t size, MemPerm perm)
-        : size(size)
-        , perm(perm) {
-    }
+// Protected segments of a fixed part of the address space, a segment never crosses the bounds of its region
+// so that faults on different regions do not wait for each other
+struct alignas(64) ProtectRegion {
+    std::mutex mutex;
+    // Sorted by start address, the segments do not overlap
+    std::vector<ProtectSegmentInfo> segments;
 };
 
-typedef std::map<Address, ProtectSegmentInfo, std::greater<>> ProtectSegmentTrees;
+constexpr uint32_t PROTECT_REGION_SHIFT = 26; // 64 MiB
+constexpr uint32_t PROTECT_REGION_COUNT = 1U << (32 - PROTECT_REGION_SHIFT);
 
 struct MemExternalMapping {
     Address address;
@@ -65,17 +81,24 @@ struct MemExternalMapping {
 
 struct MemState {
     std::mutex generation_mutex;
+    // Guards external_mapping
     std::mutex protect_mutex;
 
     uint32_t page_size = 0;
     Memory memory;
     AllocPageTable alloc_table;
     BitmapAllocator allocator;
-    ProtectSegmentTrees protect_tree;
+    std::array<ProtectRegion, PROTECT_REGION_COUNT> protect_regions;
+
+    // Accesses handled by handle_access_violation and the time spent in it
+    std::atomic<uint64_t> protect_fault_count = 0;
+    std::atomic<uint64_t> protect_fault_nanoseconds = 0;
 
     PageNameMap page_name_map;
 
     bool use_page_table = false;
     PageTable page_table;
     std::map<uint64_t, MemExternalMapping, std::greater<>> external_mapping;
+
+    ~MemState();
 };
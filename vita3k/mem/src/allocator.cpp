@@ -17,9 +17,14 @@
 
 #include <mem/allocator.h>
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
 BitmapAllocator::BitmapAllocator(const std::size_t total_bits)
     : words((total_bits >> 5) + ((total_bits % 32 != 0) ? 1 : 0), 0xFFFFFFFF)
     , max_offset(total_bits) {
+    rebuild_summary();
 }
 
 void BitmapAllocator::set_maximum(const std::size_t total_bits) {
@@ -35,13 +40,83 @@ void BitmapAllocator::set_maximum(const std::size_t total_bits) {
     }
 
     max_offset = total_bits;
+    rebuild_summary();
 }
 
 void BitmapAllocator::reset() {
     words.clear();
+    rebuild_summary();
+}
+
+void BitmapAllocator::update_summary(const std::size_t word_index) {
+    const std::size_t entry = word_index >> 6;
+    const std::uint64_t word_bit = 1ULL << (word_index & 63);
+    if (words[word_index] != 0) {
+        word_summary[entry] |= word_bit;
+    } else {
+        word_summary[entry] &= ~word_bit;
+    }
+
+    const std::uint64_t entry_bit = 1ULL << (entry & 63);
+    if (word_summary[entry] != 0) {
+        group_summary[entry >> 6] |= entry_bit;
+    } else {
+        group_summary[entry >> 6] &= ~entry_bit;
+    }
+}
+
+void BitmapAllocator::rebuild_summary() {
+    word_summary.assign((words.size() + 63) >> 6, 0);
+    group_summary.assign((word_summary.size() + 63) >> 6, 0);
+
+    for (std::size_t i = 0; i < words.size(); i++) {
+        if (words[i] != 0)
+            word_summary[i >> 6] |= 1ULL << (i & 63);
+    }
+
+    for (std::size_t i = 0; i < word_summary.size(); i++) {
+        if (word_summary[i] != 0)
+            group_summary[i >> 6] |= 1ULL << (i & 63);
+    }
+}
+
+std::size_t BitmapAllocator::next_free_word(const std::size_t word_index) const {
+    std::size_t entry = word_index >> 6;
+    if (entry >= word_summary.size())
+        return words.size();
+
+    const std::uint64_t word_bits = word_summary[entry] & (~0ULL << (word_index & 63));
+    if (word_bits != 0)
+        return (entry << 6) + std::countr_zero(word_bits);
+
+    // Look for the next summary entry with a free word
+    entry++;
+    std::size_t group = entry >> 6;
+    if (group >= group_summary.size())
+        return words.size();
+
+    std::uint64_t group_bits = group_summary[group] & (~0ULL << (entry & 63));
+    while (group_bits == 0) {
+        if (++group >= group_summary.size())
+            return words.size();
+
+        group_bits = group_summary[group];
+    }
+
+    entry = (group << 6) + std::countr_zero(group_bits);
+    return (entry << 6) + std::countr_zero(word_summary[entry]);
 }
 
 int BitmapAllocator::force_fill(const std::uint32_t offset, const std::uint32_t size, const bool or_mode) {
+    const auto refresh_summary = [&]() {
+        if (size == 0)
+            return;
+
+        const std::size_t last_word = std::min<std::size_t>((static_cast<std::size_t>(offset) + size - 1) >> 5, words.size() - 1);
+        for (std::size_t i = offset >> 5; i <= last_word; i++)
+            update_summary(i);
+    };
+
     std::uint32_t *word = &words[0] + (offset >> 5);
     const std::uint32_t set_bit = offset & 31;
     std::uint32_t end_bit = set_bit + size;
@@ -58,6 +133,7 @@ int BitmapAllocator::force_fill(const std::uint32_t offset, const std::uint32_t
             *word = wval & (~mask);
         }
 
+        refresh_summary();
         return std::min<int>(size, (words.size() << 5) - set_bit);
     }
 
@@ -86,6 +162,7 @@ int BitmapAllocator::force_fill(const std::uint32_t offset, const std::uint32_t
         }
     }
 
+    refresh_summary();
     return std::min<int>(size, (words.size() << 5) - set_bit);
 }
 
@@ -97,81 +174,143 @@ void BitmapAllocator::free(const std::uint32_t offset, const std::uint32_t size)
     force_fill(offset, size, true);
 }
 
+// Set the bit of every slot starting a run of at least length free slots inside the word
+static std::uint32_t run_starts(std::uint32_t word, const std::uint32_t length) {
+    if (length > 32) {
+        return 0;
+    }
+
+    std::uint32_t covered = 1;
+    while (covered * 2 <= length) {
+        word &= word << covered;
+        covered *= 2;
+    }
+
+    if (covered < length) {
+        word &= word << (length - covered);
+    }
+
+    return word;
+}
+
 int BitmapAllocator::allocate_from(const std::uint32_t start_offset, std::uint32_t &size, const bool best_fit) {
     if (words.empty()) {
         return -1;
     }
 
-    std::uint32_t *word = &words[0] + (start_offset >> 5);
-
-    // We have arrived at le word that still have free position (bit 1)
-    std::uint32_t *word_end = &words[words.size() - 1];
-
-    int bflmin = 0xFFFFFF;
-    int bofmin = -1;
-    std::uint32_t *wordmin = nullptr;
-
-    // Keep finding
-    while (word <= word_end) {
-        std::uint32_t wv = *word;
-
-        if (wv != 0) {
-            // Still have free stuff
-            int bflen = 0;
-            int boff = 0;
-            std::uint32_t *bword = nullptr;
-
-            int cursor = 31;
-
-            while (cursor >= 0) {
-                if (((wv >> cursor) & 1) == 1) {
-                    boff = cursor;
-                    bflen = 0;
-                    bword = word;
-
-                    while (cursor >= 0 && (((wv >> cursor) & 1) == 1)) {
-                        bflen++;
-                        cursor--;
-
-                        if (cursor < 0 && (word + 1 <= word_end)) {
-                            cursor = 31;
-                            word++;
-                            wv = *word;
-                        }
-                    }
-
-                    if (bflen >= size) {
-                        if (!best_fit) {
-                            // Force allocate and then return
-                            const int offset = static_cast<int>(31 - boff + ((bword - &words[0]) << 5));
-                            if ((static_cast<std::size_t>(offset) + size) <= max_offset) {
-                                size = force_fill(static_cast<const std::uint32_t>(offset), size, false);
-                                return offset;
-                            }
-                        } else {
-                            if (bflen < bflmin) {
-                                bflmin = bflen;
-                                bofmin = boff;
-                                wordmin = bword;
-                            }
-                        }
-                    }
+    const std::size_t total_bits = words.size() << 5;
+    std::size_t best_offset = total_bits;
+    std::size_t best_length = SIZE_MAX;
+
+    // Return true once the search is over
+    const auto check_run = [&](const std::size_t run_start, const std::size_t run_length) {
+        if (run_length < size) {
+            return false;
+        }
+
+        if (!best_fit) {
+            if (run_start + size > max_offset) {
+                return false;
+            }
+
+            best_offset = run_start;
+            return true;
+        }
+
+        if (run_length < best_length) {
+            best_length = run_length;
+            best_offset = run_start;
+        }
+
+        // Nothing can fit better
+        return run_length == size;
+    };
+
+    // The runs are walked from the beginning of the word holding start_offset, a run going over several words
+    // is carried from one word to the next
+    std::size_t carry_start = 0;
+    std::size_t carry_length = 0;
+
+    std::size_t index = start_offset >> 5;
+    while (index < words.size()) {
+        const std::uint32_t word = words[index];
+        const std::size_t word_start = index << 5;
+
+        if (word == 0) {
+            if (carry_length != 0) {
+                if (check_run(carry_start, carry_length))
+                    break;
+
+                carry_length = 0;
+            }
+
+            // Skip the allocated words with the summary
+            index = next_free_word(index + 1);
+            while (index < words.size() && words[index] == 0) {
+                // The word was allocated without updating the summary
+                update_summary(index);
+                index = next_free_word(index + 1);
+            }
+
+            continue;
+        }
+
+        std::uint32_t rest = word;
+        if (carry_length != 0) {
+            const int leading = std::countl_one(word);
+            carry_length += leading;
+            if (leading == 32) {
+                index++;
+                continue;
+            }
+
+            if (check_run(carry_start, carry_length))
+                break;
+
+            carry_length = 0;
+            rest &= 0xFFFFFFFFU >> leading;
+        }
+
+        // The run reaching the end of the word is carried, only the runs inside of it are checked here
+        const int trailing = std::countr_one(rest);
+        std::uint32_t inside = trailing == 32 ? 0 : rest & ~((1U << trailing) - 1);
+
+        if (run_starts(inside, size) != 0) {
+            if (!best_fit) {
+                // The first slot which can start the allocation always starts a run
+                if (check_run(word_start + std::countl_zero(run_starts(inside, size)), size))
+                    break;
+            } else {
+                bool done = false;
+                while (inside != 0 && !done) {
+                    const int run_offset = std::countl_zero(inside);
+                    const int run_length = std::countl_one(inside << run_offset);
+                    done = check_run(word_start + run_offset, run_length);
+                    inside &= run_offset + run_length == 32 ? 0 : 0xFFFFFFFFU >> (run_offset + run_length);
                 }
 
-                cursor--;
+                if (done)
+                    break;
             }
         }
 
-        word++;
+        if (trailing != 0) {
+            carry_start = word_start + 32 - trailing;
+            carry_length = trailing;
+        }
+
+        index++;
+    }
+
+    // The run reaching the end of the bitmap
+    if (index >= words.size() && carry_length != 0) {
+        check_run(carry_start, carry_length);
     }
 
-    if (best_fit && bofmin != -1) {
+    if (best_offset != total_bits && best_offset + size <= max_offset) {
         // Force allocate and then return
-        const int offset = static_cast<int>(31 - bofmin + ((wordmin - &words[0]) << 5));
-        if ((static_cast<std::size_t>(offset) + size) <= max_offset) {
-            size = force_fill(static_cast<std::uint32_t>(offset), size, false);
-            return offset;
-        }
+        size = force_fill(static_cast<std::uint32_t>(best_offset), size, false);
+        return static_cast<int>(best_offset);
     }
 
     return -1;
@@ -186,19 +325,6 @@ int BitmapAllocator::allocate_at(const std::uint32_t start_offset, std::uint32_t
     return 0;
 }
 
-#ifdef __cpp_lib_bitops
-#include <bit>
-static int number_of_set_bits(std::uint32_t i) {
-    return std::popcount(i);
-}
-#else
-static int number_of_set_bits(std::uint32_t i) {
-    i = i - ((i >> 1) & 0x55555555);
-    i = (i & 0x33333333) + ((i >> 2) & 0x33333333);
-    return (((i + (i >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
-}
-#endif
-
 int BitmapAllocator::free_slot_count(const std::uint32_t offset, const std::uint32_t offset_end) const {
     if (offset >= offset_end) {
         return -1;
@@ -222,7 +348,7 @@ int BitmapAllocator::free_slot_count(const std::uint32_t offset, const std::uint
         const int left_shift = start_bit & 31;
         const int right_shift = (31 - (next_end_bit - 1) & 31);
         std::uint32_t word_to_scan = words[start_bit >> 5] << left_shift >> right_shift >> left_shift;
-        free_count += number_of_set_bits(word_to_scan);
+        free_count += std::popcount(word_to_scan);
 
         start_bit = next_end_bit;
     }
@@ -23,7 +23,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstring>
+#include <iterator>
 #include <mutex>
 #include <utility>
 
@@ -58,6 +60,12 @@ static std::string get_error_msg() {
 }
 #endif
 
+MemState::~MemState() {
+    const uint64_t fault_count = protect_fault_count;
+    if (fault_count > 0)
+        LOG_INFO("Handled {} write protection faults, {} ns on average", fault_count, protect_fault_nanoseconds / fault_count);
+}
+
 bool init(MemState &state, const bool use_page_table) {
 #ifdef _WIN32
     SYSTEM_INFO system_info = {};
@@ -250,15 +258,38 @@ void protect_inner(MemState &state, Address addr, uint32_t size, const MemPerm p
 #endif
 }
 
+static ProtectRegion &get_protect_region(MemState &state, Address addr) {
+    return state.protect_regions[addr >> PROTECT_REGION_SHIFT];
+}
+
+// Segment with the highest start address not above addr, or the end of the segments
+static std::vector<ProtectSegmentInfo>::iterator find_segment_before(ProtectRegion &region, Address addr) {
+    const auto it = std::upper_bound(region.segments.begin(), region.segments.end(), addr, [](Address addr, const ProtectSegmentInfo &segment) {
+        return addr < segment.start;
+    });
+
+    return it == region.segments.begin() ? region.segments.end() : std::prev(it);
+}
+
+// Segment containing addr, or the end of the segments
+static std::vector<ProtectSegmentInfo>::iterator find_segment(ProtectRegion &region, Address addr) {
+    const auto it = find_segment_before(region, addr);
+    if (it != region.segments.end() && addr >= it->start + it->size)
+        return region.segments.end();
+
+    return it;
+}
+
 bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcept {
+    const auto handling_start = std::chrono::steady_clock::now();
     const uintptr_t memory_addr = reinterpret_cast<uintptr_t>(state.memory.get());
     const uintptr_t fault_addr = reinterpret_cast<uintptr_t>(addr);
 
     Address vaddr = 0;
-    const std::unique_lock<std::mutex> lock(state.protect_mutex);
     if (fault_addr < memory_addr || fault_addr >= memory_addr + TOTAL_MEM_SIZE) {
         if (state.use_page_table) {
             // this may come from an external mapping
+            const std::lock_guard<std::mutex> lock(state.protect_mutex);
             uint64_t addr_val = std::bit_cast<uint64_t>(addr);
             auto it = state.external_mapping.lower_bound(addr_val);
             if (it != state.external_mapping.end() && addr_val < it->first + it->second.size) {
@@ -280,109 +311,128 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
         fmt::print("Access: {}\n", log_hex(vaddr));
     }
 
-    auto it = state.protect_tree.lower_bound(vaddr);
-    if (it == state.protect_tree.end()) {
-        // HACK: keep going
-        unprotect_inner(state, vaddr, 4);
-        LOG_CRITICAL("Unhandled write protected region was valid. Address=0x{:X}", vaddr);
-        return true;
-    }
+    const auto count_fault = [&]() {
+        const auto handling_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - handling_start);
+        state.protect_fault_count.fetch_add(1, std::memory_order_relaxed);
+        state.protect_fault_nanoseconds.fetch_add(handling_time.count(), std::memory_order_relaxed);
+    };
+
+    // Only the region of the address is locked, faults on other regions are handled meanwhile
+    ProtectRegion &region = get_protect_region(state, vaddr);
+    const std::lock_guard<std::mutex> lock(region.mutex);
 
-    ProtectSegmentInfo &info = it->second;
-    if (vaddr < it->first || vaddr >= it->first + info.size) {
+    const auto it = find_segment(region, vaddr);
+    if (it == region.segments.end()) {
         // HACK: keep going
         unprotect_inner(state, vaddr, 4);
         LOG_CRITICAL("Unhandled write protected region was valid. Address=0x{:X}", vaddr);
+        count_fault();
         return true;
     }
 
-    Address previous_beg = it->first;
-    for (auto ite = info.blocks.begin(); ite != info.blocks.end();) {
-        if (vaddr >= ite->first && vaddr < ite->first + ite->second.size && ite->second.callback(vaddr, write)) {
-            Address beg_unpr = align_down(ite->first, state.page_size);
-            Address end_unpr = align(ite->first + ite->second.size, state.page_size);
+    ProtectSegmentInfo &info = *it;
+    for (auto block = info.blocks.begin(); block != info.blocks.end();) {
+        // the callback is not called again for the pieces of a block which was released through another region
+        if (vaddr >= block->addr && vaddr < block->addr + block->size && (block->handler->released || block->handler->callback(vaddr, write))) {
+            block->handler->released = true;
+
+            Address beg_unpr = align_down(block->addr, state.page_size);
+            Address end_unpr = align(block->addr + block->size, state.page_size);
             unprotect_inner(state, beg_unpr, end_unpr - beg_unpr);
 
-            ite = info.blocks.erase(ite);
+            block = info.blocks.erase(block);
         } else {
-            ++ite;
+            ++block;
         }
     }
 
-    if (info.blocks.empty() && info.ref_count == 0) {
-        unprotect_inner(state, it->first, info.size);
-        state.protect_tree.erase(it);
+    if (info.blocks.empty()) {
+        if (info.ref_count == 0) {
+            unprotect_inner(state, info.start, info.size);
+            region.segments.erase(it);
+        }
     } else {
-        Address beg_region = info.blocks.begin()->first;
-        Address end_region = info.blocks.rbegin()->first + info.blocks.rbegin()->second.size;
+        // The segment shrinks to the blocks left, this keeps it in place in the sorted segments
+        Address end_region = 0;
+        for (const ProtectBlockInfo &block : info.blocks)
+            end_region = std::max(end_region, block.addr + block.size);
 
-        beg_region = align_down(beg_region, state.page_size);
+        const Address beg_region = align_down(info.blocks.front().addr, state.page_size);
         end_region = align(end_region, state.page_size);
 
-        if (beg_region != previous_beg) {
-            ProtectSegmentInfo new_info = std::move(info);
-            new_info.size = end_region - beg_region;
-
-            state.protect_tree.erase(it);
-            state.protect_tree.emplace(beg_region, std::move(new_info));
-        } else {
-            info.size = end_region - beg_region;
-        }
+        info.start = beg_region;
+        info.size = end_region - beg_region;
     }
 
+    count_fault();
     return true;
 }
 
-bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const ProtectCallback &callback) {
-    const std::lock_guard<std::mutex> lock(state.protect_mutex);
-    ProtectSegmentInfo protect(size, perm);
-    align_to_page(state, addr, protect.size);
-
-    ProtectBlockInfo block;
-    block.size = size;
-    block.callback = callback;
-
-    protect.blocks.emplace(addr, std::move(block));
+static void add_protect_piece(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const std::shared_ptr<ProtectHandler> &handler) {
+    ProtectRegion &region = get_protect_region(state, addr);
+    const std::lock_guard<std::mutex> lock(region.mutex);
+
+    ProtectSegmentInfo protect;
+    protect.start = addr;
+    protect.size = size;
+    protect.perm = perm;
+    align_to_page(state, protect.start, protect.size);
+    protect.blocks.push_back({ addr, size, handler });
+
+    // Merge the segments overlapping the new one, including the empty ones opened in its range
+    auto first = find_segment_before(region, protect.start);
+    if (first == region.segments.end())
+        first = region.segments.begin();
+    else if (first->start + first->size <= protect.start)
+        ++first;
+
+    const Address end = protect.start + protect.size;
+    auto last = first;
+    for (; last != region.segments.end() && last->start < end; ++last) {
+        const Address start = std::min(last->start, protect.start);
+        protect.size = std::max(last->start + last->size, protect.start + protect.size) - start;
+        protect.start = start;
+        protect.ref_count += last->ref_count; // Transfer access count to new block
+        std::move(last->blocks.begin(), last->blocks.end(), std::back_inserter(protect.blocks)); // transfer blocks to the new protect
+    }
+
+    std::stable_sort(protect.blocks.begin(), protect.blocks.end(), [](const ProtectBlockInfo &a, const ProtectBlockInfo &b) {
+        return a.addr < b.addr;
+    });
 
-    auto it = state.protect_tree.lower_bound(addr);
-    if (it == state.protect_tree.end() || it->first + it->second.size <= addr) {
-        if (it == state.protect_tree.begin())
-            it = state.protect_tree.end();
-        else
-            --it;
+    if (protect.ref_count == 0) {
+        protect_inner(state, protect.start, protect.size, perm);
     }
 
-    while (it != state.protect_tree.end() && it->first < addr + size) {
-        const Address start = std::min(it->first, addr);
-        protect.size = std::max(it->first + it->second.size, addr + protect.size) - start;
-        addr = start;
-        protect.ref_count += it->second.ref_count; // Transfer access count to new block
-        protect.blocks.merge(it->second.blocks); // transfer blocks to the new protect
-
-        if (it == state.protect_tree.begin()) {
-            state.protect_tree.erase(it);
-            break;
-        }
-
-        // protect tree is in reverse order, so decrease it
-        state.protect_tree.erase(it--);
-    }
+    const auto position = region.segments.erase(first, last);
+    region.segments.insert(position, std::move(protect));
+}
 
-    if (protect.ref_count == 0) {
-        protect_inner(state, addr, protect.size, perm);
-    }
+bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const ProtectCallback &callback) {
+    const auto handler = std::make_shared<ProtectHandler>();
+    handler->callback = callback;
+
+    // The block is protected separately in each region it covers
+    const uint64_t end = static_cast<uint64_t>(addr) + size;
+    uint64_t piece_start = addr;
+    do {
+        const uint64_t region_end = ((piece_start >> PROTECT_REGION_SHIFT) + 1) << PROTECT_REGION_SHIFT;
+        const uint64_t piece_end = std::min(end, region_end);
+        add_protect_piece(state, static_cast<Address>(piece_start), static_cast<uint32_t>(piece_end - piece_start), perm, handler);
+        piece_start = piece_end;
+    } while (piece_start < end);
 
-    state.protect_tree.emplace(addr, std::move(protect));
     return true;
 }
 
 bool is_protecting(MemState &state, Address addr, MemPerm *perm) {
-    const std::lock_guard<std::mutex> lock(state.protect_mutex);
-    auto ite = state.protect_tree.lower_bound(addr);
+    ProtectRegion &region = get_protect_region(state, addr);
+    const std::lock_guard<std::mutex> lock(region.mutex);
+    const auto ite = find_segment(region, addr);
 
-    if (ite != state.protect_tree.end() && addr < ite->first + ite->second.size) {
+    if (ite != region.segments.end()) {
         if (perm)
-            *perm = ite->second.perm;
+            *perm = ite->perm;
 
         return true;
     }
@@ -391,34 +441,49 @@ bool is_protecting(MemState &state, Address addr, MemPerm *perm) {
 }
 
 void open_access_parent_protect_segment(MemState &state, Address addr) {
-    const std::lock_guard<std::mutex> lock(state.protect_mutex);
-    auto ite = state.protect_tree.lower_bound(addr);
+    ProtectRegion &region = get_protect_region(state, addr);
+    const std::lock_guard<std::mutex> lock(region.mutex);
+    const auto ite = find_segment(region, addr);
+
+    if (ite != region.segments.end()) {
+        ite->ref_count++;
+        return;
+    }
 
-    if (ite != state.protect_tree.end() && addr < ite->first + ite->second.size) {
-        ite->second.ref_count++;
+    // Open an empty segment, which may already be opened
+    const Address start = align_down(addr, state.page_size);
+    const auto position = std::lower_bound(region.segments.begin(), region.segments.end(), start, [](const ProtectSegmentInfo &segment, Address start) {
+        return segment.start < start;
+    });
+
+    if (position != region.segments.end() && position->start == start) {
+        position->ref_count++;
     } else {
-        ProtectSegmentInfo protect(0, MemPerm::ReadWrite);
+        ProtectSegmentInfo protect;
+        protect.start = start;
+        protect.perm = MemPerm::ReadWrite;
         protect.ref_count = 1;
 
-        state.protect_tree.emplace(align_down(addr, state.page_size), std::move(protect));
+        region.segments.insert(position, std::move(protect));
     }
 }
 
 void close_access_parent_protect_segment(MemState &state, Address addr) {
-    const std::lock_guard<std::mutex> lock(state.protect_mutex);
-    auto ite = state.protect_tree.lower_bound(addr);
+    ProtectRegion &region = get_protect_region(state, addr);
+    const std::lock_guard<std::mutex> lock(region.mutex);
+    const auto ite = find_segment_before(region, addr);
 
-    if (ite != state.protect_tree.end()) {
-        ProtectSegmentInfo &info = ite->second;
+    if (ite != region.segments.end()) {
+        ProtectSegmentInfo &info = *ite;
         if (info.ref_count > 0) {
             info.ref_count--;
         }
 
         if (info.ref_count == 0) {
             if (info.blocks.empty() || info.size == 0) {
-                state.protect_tree.erase(ite);
+                region.segments.erase(ite);
             } else {
-                protect_inner(state, ite->first, info.size, info.perm);
+                protect_inner(state, info.start, info.size, info.perm);
             }
         }
     }
@@ -459,24 +524,13 @@ void remove_external_mapping(MemState &mem, uint8_t *addr_ptr) {
 
     // remove all protections on this range
     unprotect_inner(mem, mapping.address, mapping.size);
-    {
-        const std::unique_lock<std::mutex> lock(mem.protect_mutex);
-        auto prot_it = mem.protect_tree.lower_bound(mapping.address);
-        if (prot_it->first + prot_it->second.size <= mapping.address) {
-            if (prot_it == mem.protect_tree.begin())
-                prot_it = mem.protect_tree.end();
-            else
-                --prot_it;
-        }
-
-        while (prot_it != mem.protect_tree.end() && prot_it->first < mapping.address + mapping.size) {
-            if (prot_it == mem.protect_tree.begin()) {
-                mem.protect_tree.erase(prot_it);
-                break;
-            }
-
-            mem.protect_tree.erase(prot_it--);
-        }
+    const Address mapping_end = mapping.address + mapping.size;
+    for (uint32_t region_index = mapping.address >> PROTECT_REGION_SHIFT; region_index <= (mapping_end - 1) >> PROTECT_REGION_SHIFT; region_index++) {
+        ProtectRegion &region = mem.protect_regions[region_index];
+        const std::lock_guard<std::mutex> lock(region.mutex);
+        std::erase_if(region.segments, [&](const ProtectSegmentInfo &segment) {
+            return segment.start < mapping_end && (segment.start >= mapping.address || segment.start + segment.size > mapping.address);
+        });
     }
 
     // unprotect the original memory range
@@ -15,6 +15,7 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <climits>
 #include <list>
 #include <mem/allocator.h>
 #include <mem/util.h>
@@ -151,6 +152,52 @@ TEST(bitmap_allocator, battle_test) {
     }
 }
 
+TEST(bitmap_allocator, fragmented_stress) {
+    srand(time(0));
+    constexpr int MEM_SIZE = KiB(64);
+    constexpr int TEST_EPOCH = KiB(4);
+
+    BitmapAllocator allocator(MEM_SIZE);
+
+    // Leave holes of 1 to 7 slots between the allocations so that most words are partially free
+    for (int offset = 0; offset < MEM_SIZE;) {
+        const int used = rand() % 40 + 1;
+        const int hole = rand() % 7 + 1;
+        allocator.allocate_at(offset, std::min(used, MEM_SIZE - offset));
+        offset += used + hole;
+    }
+
+    // Slow reference, the first and the smallest free run which can hold size slots
+    const auto find_run = [&](uint32_t size, bool best_fit) {
+        int best_offset = -1;
+        int best_length = INT_MAX;
+        for (int offset = 0; offset < MEM_SIZE;) {
+            int length = 0;
+            while (offset + length < MEM_SIZE && allocator.free_slot_count(offset + length, offset + length + 1) == 1)
+                length++;
+
+            if (length >= static_cast<int>(size) && (!best_fit || length < best_length)) {
+                best_offset = offset;
+                best_length = length;
+                if (!best_fit)
+                    break;
+            }
+            offset += std::max(length, 1);
+        }
+        return best_offset;
+    };
+
+    for (int i = 0; i < TEST_EPOCH; ++i) {
+        uint32_t size = rand() % 10 + 1;
+        const bool best_fit = rand() % 2;
+        const int expected = find_run(size, best_fit);
+        const int ret = allocator.allocate_from(0, size, best_fit);
+        ASSERT_EQ(ret, expected);
+        if (ret >= 0)
+            allocator.free(ret, size);
+    }
+}
+
 // These tests are from EKA2L1 (https://github.com/EKA2L1/EKA2L1/blob/4fbd057da2a0c4f66a5c0f9dfc406c5d90f7531f/src/tests/common/allocator.cpp)
 TEST(bitmap_allocator, no_best_fit_only_one_fit) {
     BitmapAllocator alloc(32);
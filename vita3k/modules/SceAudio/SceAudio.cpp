@@ -180,11 +180,7 @@ EXPORT(int, sceAudioOutOpenPort, SceAudioOutPortType type, int len, int freq, Sc
     port->freq = freq;
     port->mode = mode;
 
-    const std::lock_guard<std::mutex> lock(emuenv.audio.mutex);
-    const int port_id = emuenv.audio.next_port_id++;
-    emuenv.audio.out_ports.emplace(port_id, port);
-
-    return port_id;
+    return emuenv.audio.add_out_port(port);
 }
 
 EXPORT(int, sceAudioOutOutput, int port, const void *buf) {
@@ -211,7 +207,7 @@ EXPORT(int, sceAudioOutGetRestSample, int port) {
         return RET_ERROR(SCE_AUDIO_OUT_ERROR_INVALID_PORT);
     }
 
-    const int bytes_available = SDL_AudioStreamAvailable(prt->stream.get());
+    const int bytes_available = emuenv.audio.get_rest_bytes(*prt);
 
     // we have the number of bytes left, we can convert it back to the number of samples left
     return bytes_available / (2 * sizeof(int16_t));
@@ -224,8 +220,7 @@ EXPORT(int, sceAudioOutOpenExtPort) {
 
 EXPORT(int, sceAudioOutReleasePort, int port) {
     TRACY_FUNC(sceAudioOutReleasePort, port);
-    const std::lock_guard<std::mutex> guard(emuenv.audio.mutex);
-    if (!emuenv.audio.out_ports.erase(port)) {
+    if (!emuenv.audio.release_out_port(port)) {
         return RET_ERROR(SCE_AUDIO_OUT_ERROR_INVALID_PORT);
     }
 
@@ -288,8 +283,7 @@ EXPORT(int, sceAudioOutSetConfig, int port, int len, int freq, int mode) {
     prt->len = set_len;
     prt->mode = set_mode;
 
-    const std::lock_guard<std::mutex> lock(emuenv.audio.mutex);
-    emuenv.audio.out_ports.emplace(port, prt);
+    emuenv.audio.set_out_port(port, prt);
 
     return 0;
 }
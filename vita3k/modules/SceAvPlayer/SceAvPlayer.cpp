@@ -97,7 +97,8 @@ struct PlayerInfoState {
     bool do_loop = false;
     bool paused = false;
 
-    uint64_t last_frame_time = 0;
+    // time at which the player was paused, to delay the frames by the duration of the pause
+    uint64_t pause_time = 0;
     SceAvPlayerMemoryAllocator memory_allocator;
     SceAvPlayerFileManager file_manager;
     SceAvPlayerEventManager event_manager;
@@ -334,13 +335,12 @@ EXPORT(bool, sceAvPlayerGetAudioData, SceUID player_handle, SceAvPlayerFrameInfo
                 player_info->player.last_sample_count * sizeof(int16_t) * player_info->player.last_channels, true);
         }
     } else {
-        std::vector<int16_t> data = player_info->player.receive_audio();
-
-        if (data.empty())
+        const bool received = player_info->player.receive_audio_frame(false, true, [&](const PlayerAudioFrame &frame) {
+            buffer = get_buffer(player_info, MediaType::AUDIO, emuenv.mem, (uint32_t)frame.data.size() * sizeof(int16_t), false);
+            std::memcpy(buffer.get(emuenv.mem), frame.data.data(), frame.data.size() * sizeof(int16_t));
+        });
+        if (!received)
             return false;
-
-        buffer = get_buffer(player_info, MediaType::AUDIO, emuenv.mem, (uint32_t)data.size() * sizeof(int16_t), false);
-        std::memcpy(buffer.get(emuenv.mem), data.data(), data.size() * sizeof(int16_t));
     }
 
     frame_info->timestamp = player_info->player.last_timestamp;
@@ -371,11 +371,17 @@ EXPORT(uint32_t, sceAvPlayerGetStreamInfo, SceUID player_handle, SceUInt32 strea
         stream_info->stream_details.video.aspect_ratio = static_cast<float>(size.width) / static_cast<float>(size.height);
         strcpy(stream_info->stream_details.video.language, "ENG");
     } else if (stream_no == 1) { // audio
-        player_info->player.receive_audio(); // TODO: Get audio info without skipping data frames
         stream_info->stream_type = MediaType::AUDIO;
-        stream_info->stream_details.audio.channels = player_info->player.last_channels;
-        stream_info->stream_details.audio.sample_rate = player_info->player.last_sample_rate;
-        stream_info->stream_details.audio.size = player_info->player.last_channels * player_info->player.last_sample_count * sizeof(int16_t);
+        const bool received = player_info->player.receive_audio_frame(true, false, [&](const PlayerAudioFrame &frame) {
+            stream_info->stream_details.audio.channels = frame.channels;
+            stream_info->stream_details.audio.sample_rate = frame.sample_rate;
+            stream_info->stream_details.audio.size = frame.channels * frame.sample_count * sizeof(int16_t);
+        });
+        if (!received) {
+            stream_info->stream_details.audio.channels = player_info->player.last_channels;
+            stream_info->stream_details.audio.sample_rate = player_info->player.last_sample_rate;
+            stream_info->stream_details.audio.size = player_info->player.last_channels * player_info->player.last_sample_count * sizeof(int16_t);
+        }
         strcpy(stream_info->stream_details.audio.language, "ENG");
     } else {
         return SCE_AVPLAYER_ERROR_INVALID_ARGUMENT;
@@ -394,28 +400,23 @@ EXPORT(bool, sceAvPlayerGetVideoData, SceUID player_handle, SceAvPlayerFrameInfo
 
     DecoderSize size = player_info->player.get_size();
 
-    uint64_t framerate = player_info->player.get_framerate_microseconds();
-
-    // needs new frame
-    if (player_info->last_frame_time + framerate < current_time()) {
-        if (CATCHUP_VIDEO_PLAYBACK)
-            player_info->last_frame_time += framerate;
+    if (player_info->paused) {
+        if (REJECT_DATA_ON_PAUSE)
+            return false;
         else
-            player_info->last_frame_time = current_time();
+            buffer = get_buffer(player_info, MediaType::VIDEO, emuenv.mem, H264DecoderState::buffer_size(size), false);
+    } else {
+        // needs new frame, copied while the player still holds it
+        const auto receive_frame = [&](const PlayerVideoFrame &frame) {
+            if (!CATCHUP_VIDEO_PLAYBACK)
+                player_info->player.clock_start = current_time() - frame.presentation_time;
 
-        if (player_info->paused) {
-            if (REJECT_DATA_ON_PAUSE)
-                return false;
-            else
-                buffer = get_buffer(player_info, MediaType::VIDEO, emuenv.mem, H264DecoderState::buffer_size(size), false);
-        } else {
+            size = frame.size;
             buffer = get_buffer(player_info, MediaType::VIDEO, emuenv.mem, H264DecoderState::buffer_size(size), true);
-
-            std::vector<uint8_t> data = player_info->player.receive_video();
-            std::memcpy(buffer.get(emuenv.mem), data.data(), data.size());
-        }
-    } else {
-        buffer = get_buffer(player_info, MediaType::VIDEO, emuenv.mem, H264DecoderState::buffer_size(size), false);
+            std::memcpy(buffer.get(emuenv.mem), frame.data.data(), frame.data.size());
+        };
+        if (!player_info->player.receive_video_frame(current_time(), receive_frame))
+            buffer = get_buffer(player_info, MediaType::VIDEO, emuenv.mem, H264DecoderState::buffer_size(size), false);
     }
     // TODO: catch eof error and call
     // uint32_t buf = SCE_AVPLAYER_ERROR_MAYBE_EOF;
@@ -442,7 +443,6 @@ EXPORT(SceUID, sceAvPlayerInit, SceAvPlayerInfo *info) {
     PlayerPtr player = std::make_shared<PlayerInfoState>();
     state->players[player_handle] = player;
 
-    player->last_frame_time = current_time();
     player->memory_allocator = info->memory_allocator;
     player->file_manager = info->file_manager;
     player->event_manager = info->event_manager;
@@ -459,7 +459,7 @@ EXPORT(bool, sceAvPlayerIsActive, SceUID player_handle) {
     const auto state = emuenv.kernel.obj_store.get<AvPlayerState>();
     const PlayerPtr &player_info = lock_and_find(player_handle, state->players, state->mutex);
 
-    return !player_info->player.video_playing.empty();
+    return player_info->player.is_active();
 }
 
 EXPORT(int, sceAvPlayerJumpToTime) {
@@ -469,6 +469,8 @@ EXPORT(int, sceAvPlayerJumpToTime) {
 EXPORT(int, sceAvPlayerPause, SceUID player_handle) {
     const auto state = emuenv.kernel.obj_store.get<AvPlayerState>();
     const PlayerPtr &player_info = lock_and_find(player_handle, state->players, state->mutex);
+    if (!player_info->paused)
+        player_info->pause_time = current_time();
     player_info->paused = true;
     const auto thread = emuenv.kernel.get_thread(thread_id);
     run_event_callback(emuenv, thread, player_info, SCE_AVPLAYER_STATE_PAUSE, 0, Ptr<void>(0));
@@ -485,6 +487,8 @@ EXPORT(int, sceAvPlayerResume, SceUID player_handle) {
     if (!player_info->paused) {
         const auto thread = emuenv.kernel.get_thread(thread_id);
         run_event_callback(emuenv, thread, player_info, SCE_AVPLAYER_STATE_PLAY, 0, Ptr<void>(0));
+    } else {
+        player_info->player.clock_start += current_time() - player_info->pause_time;
     }
     player_info->paused = false;
     return 0;
@@ -505,9 +509,7 @@ EXPORT(int, sceAvPlayerSetTrickSpeed) {
 EXPORT(int, sceAvPlayerStart, SceUID player_handle) {
     const auto state = emuenv.kernel.obj_store.get<AvPlayerState>();
     const PlayerPtr &player_info = lock_and_find(player_handle, state->players, state->mutex);
-    if (!player_info->player.videos_queue.empty()) {
-        player_info->player.pop_video();
-    }
+    player_info->player.pop_video();
     const auto thread = emuenv.kernel.get_thread(thread_id);
     run_event_callback(emuenv, thread, player_info, SCE_AVPLAYER_STATE_PLAY, 0, Ptr<void>(0));
     return 0;
@@ -17,84 +17,379 @@
 
 #include <module/module.h>
 
+#include <io/fios.h>
+#include <io/functions.h>
+#include <io/io.h>
+#include <kernel/state.h>
+#include <kernel/sync_primitives.h>
+#include <kernel/types.h>
+
+#include <algorithm>
+#include <cstring>
+
+constexpr int SCE_FIOS_OK = 0;
+constexpr int SCE_FIOS_ERROR_BAD_PATH = 0x80820005;
+constexpr int SCE_FIOS_ERROR_BAD_PTR = 0x80820006;
+constexpr int SCE_FIOS_ERROR_BAD_OFFSET = 0x80820007;
+constexpr int SCE_FIOS_ERROR_BAD_SIZE = 0x80820008;
+constexpr int SCE_FIOS_ERROR_BAD_OP = 0x8082000A;
+constexpr int SCE_FIOS_ERROR_BAD_FH = 0x8082000B;
+constexpr int SCE_FIOS_ERROR_CANCELLED = 0x80820012;
+constexpr int SCE_FIOS_ERROR_ACCESS = 0x80820013;
+constexpr int SCE_FIOS_ERROR_DECOMPRESSION = 0x80820014;
+
+constexpr SceUID SCE_FIOS_OP_INVALID = 0;
+
+typedef SceUID SceFiosFH;
+typedef SceUID SceFiosOp;
+typedef int64_t SceFiosSize;
+typedef int64_t SceFiosOffset;
+
+enum SceFiosOpenFlags : uint16_t {
+    SCE_FIOS_O_READ = 1 << 0,
+    SCE_FIOS_O_WRITE = 1 << 1,
+    SCE_FIOS_O_APPEND = 1 << 2,
+    SCE_FIOS_O_CREAT = 1 << 3,
+    SCE_FIOS_O_TRUNC = 1 << 4
+};
+
+enum SceFiosWhence {
+    SCE_FIOS_SEEK_SET = 0,
+    SCE_FIOS_SEEK_CUR = 1,
+    SCE_FIOS_SEEK_END = 2
+};
+
+struct SceFiosOpAttr {
+    int64_t deadline;
+    Ptr<void> pCallback;
+    Ptr<void> pCallbackContext;
+    int32_t priority : 8;
+    uint32_t opflags : 24;
+    uint32_t userTag;
+    Ptr<void> userPtr;
+    Ptr<void> pReserved;
+};
+
+struct SceFiosOpenParams {
+    uint32_t openFlags : 16;
+    uint32_t opFlags : 16;
+    uint32_t reserved;
+    Ptr<void> buffer;
+    SceSize buffer_length;
+};
+
+static int to_fios_error(const int error) {
+    switch (error) {
+    case SCE_ERROR_ERRNO_ENOENT:
+        return SCE_FIOS_ERROR_BAD_PATH;
+    case SCE_ERROR_ERRNO_EBADFD:
+        return SCE_FIOS_ERROR_BAD_FH;
+    case SCE_ERROR_ERRNO_EIO:
+        return SCE_FIOS_ERROR_DECOMPRESSION;
+    default:
+        return SCE_FIOS_ERROR_ACCESS;
+    }
+}
+
+static int to_io_flags(const SceFiosOpenParams *params) {
+    if (!params)
+        return SCE_O_RDONLY;
+
+    const uint32_t flags = params->openFlags;
+    int io_flags = 0;
+    if ((flags & SCE_FIOS_O_READ) && (flags & SCE_FIOS_O_WRITE))
+        io_flags = SCE_O_RDWR;
+    else if (flags & SCE_FIOS_O_WRITE)
+        io_flags = SCE_O_WRONLY;
+    else
+        io_flags = SCE_O_RDONLY;
+
+    if (flags & SCE_FIOS_O_APPEND)
+        io_flags |= SCE_O_APPEND;
+    if (flags & SCE_FIOS_O_CREAT)
+        io_flags |= SCE_O_CREAT;
+    if (flags & SCE_FIOS_O_TRUNC)
+        io_flags |= SCE_O_TRUNC;
+
+    return io_flags;
+}
+
+// Run the operation on the FIOS thread, its result is either an error or the number of bytes processed
+static SceFiosOp start_op(EmuEnvState &emuenv, const SceUID thread_id, const char *export_name, const SceFiosOpAttr *attr, const SceOff request_count, std::function<SceOff()> func) {
+    if (attr && attr->pCallback)
+        LOG_WARN_ONCE("{}: FIOS operation callbacks are not supported", export_name);
+
+    const SceUID event_id = simple_event_create(emuenv.kernel, emuenv.mem, export_name, "SceFiosOp", thread_id, SCE_KERNEL_ATTR_TH_FIFO, 0);
+    if (event_id < 0)
+        return SCE_FIOS_OP_INVALID;
+
+    auto op = std::make_shared<FiosOp>();
+    op->id = event_id;
+    op->request_count = request_count;
+    {
+        const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+        emuenv.io.fios.ops.emplace(event_id, op);
+    }
+
+    KernelState &kernel = emuenv.kernel;
+    fios_run_async(emuenv.io, [&kernel, thread_id, op, func = std::move(func)]() {
+        const SceOff result = op->cancelled ? SCE_FIOS_ERROR_CANCELLED : func();
+        if (result < 0)
+            op->error = static_cast<int>(result);
+        else
+            op->actual_count = result;
+
+        op->done = true;
+        simple_event_setorpulse(kernel, "sceFiosOp", thread_id, op->id, SCE_KERNEL_EVENT_IN, 0, true);
+    });
+
+    return event_id;
+}
+
+// Operation completing with a result known when it is issued
+static SceFiosOp complete_op(EmuEnvState &emuenv, const SceUID thread_id, const char *export_name, const SceFiosOpAttr *attr, const SceOff result) {
+    return start_op(emuenv, thread_id, export_name, attr, 0, [result]() { return result; });
+}
+
+static std::shared_ptr<FiosOp> get_op(EmuEnvState &emuenv, const SceFiosOp op) {
+    const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+    const auto it = emuenv.io.fios.ops.find(op);
+    return it == emuenv.io.fios.ops.end() ? nullptr : it->second;
+}
+
+static int wait_op(EmuEnvState &emuenv, const SceUID thread_id, const char *export_name, const FiosOp &op) {
+    if (op.done)
+        return SCE_FIOS_OK;
+
+    return simple_event_waitorpoll(emuenv.kernel, export_name, thread_id, op.id, SCE_KERNEL_EVENT_IN, nullptr, nullptr, nullptr, true);
+}
+
+static void delete_op(EmuEnvState &emuenv, const SceUID thread_id, const char *export_name, FiosOp &op) {
+    // the event is set by the FIOS thread, so it can only be deleted once the operation is done
+    op.cancelled = true;
+    wait_op(emuenv, thread_id, export_name, op);
+
+    {
+        const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+        emuenv.io.fios.ops.erase(op.id);
+    }
+    simple_event_delete(emuenv.kernel, export_name, thread_id, op.id);
+}
+
+static SceOff open_fh(EmuEnvState &emuenv, const char *export_name, SceFiosFH *out_fh, const char *path, const SceFiosOpenParams *params) {
+    if (!out_fh)
+        return SCE_FIOS_ERROR_BAD_PTR;
+    if (!path)
+        return SCE_FIOS_ERROR_BAD_PATH;
+
+    const SceUID fh = fios_open_file(emuenv.io, path, to_io_flags(params), emuenv.pref_path, export_name);
+    if (fh < 0)
+        return to_fios_error(fh);
+
+    *out_fh = fh;
+    return SCE_FIOS_OK;
+}
+
+static SceOff read_fh(IOState &io, const std::shared_ptr<FiosFile> &file, void *buf, const SceFiosSize length, const SceFiosOffset offset) {
+    const SceOff res = fios_read_file(io, *file, buf, length, offset);
+    return res < 0 ? to_fios_error(static_cast<int>(res)) : res;
+}
+
+static SceOff check_read(const std::shared_ptr<FiosFile> &file, const void *buf, const SceFiosSize length, const SceFiosOffset offset) {
+    if (!file)
+        return SCE_FIOS_ERROR_BAD_FH;
+    if (!buf)
+        return SCE_FIOS_ERROR_BAD_PTR;
+    if (length < 0)
+        return SCE_FIOS_ERROR_BAD_SIZE;
+    if (offset < 0)
+        return SCE_FIOS_ERROR_BAD_OFFSET;
+
+    return SCE_FIOS_OK;
+}
+
+// Offset of the next sceFiosFHRead, which is moved past the data it reads when it is issued
+static SceFiosOffset advance_position(IOState &io, FiosFile &file, const SceFiosSize length) {
+    const std::lock_guard<std::mutex> guard(io.fios.mutex);
+    const SceFiosOffset offset = file.position;
+    file.position += std::clamp<SceFiosSize>(file.size - offset, 0, length);
+    return offset;
+}
+
+static SceOff prefetch_fh(IOState &io, const std::shared_ptr<FiosFile> &file, const SceFiosOffset offset, const SceFiosSize length) {
+    const int res = fios_prefetch_file(io, *file, offset, length);
+    return res < 0 ? to_fios_error(res) : SCE_FIOS_OK;
+}
+
+/**
+ * \brief Call func with a handle to the file at the given path, which is closed once func returns.
+ *
+ * The file is opened on the calling thread, func may keep the handle to use it later.
+ */
+template <typename F>
+static SceOff with_file(EmuEnvState &emuenv, const char *export_name, const char *path, F &&func) {
+    if (!path)
+        return SCE_FIOS_ERROR_BAD_PATH;
+
+    const SceUID fh = fios_open_file(emuenv.io, path, SCE_O_RDONLY, emuenv.pref_path, export_name);
+    if (fh < 0)
+        return to_fios_error(fh);
+
+    const SceOff res = func(fios_get_file(emuenv.io, fh));
+    fios_close_file(emuenv.io, fh, export_name);
+    return res;
+}
+
+
 EXPORT(int, sceFiosArchiveGetDecompressorThreadCount) {
-    return UNIMPLEMENTED();
+    const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+    return static_cast<int>(emuenv.io.fios.decompressor_thread_count);
 }
 
-EXPORT(int, sceFiosArchiveGetMountBufferSize) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosArchiveGetMountBufferSize, const SceFiosOpAttr *pAttr, const char *pArchivePath, const void *pOpenParams) {
+    if (!pArchivePath)
+        return complete_op(emuenv, thread_id, export_name, pAttr, SCE_FIOS_ERROR_BAD_PATH);
+
+    // the size is the actual count of the operation
+    const int res = fios_get_archive_mount_size(emuenv.io, pArchivePath, emuenv.pref_path, export_name);
+    return complete_op(emuenv, thread_id, export_name, pAttr, res < 0 ? to_fios_error(res) : res);
 }
 
-EXPORT(int, sceFiosArchiveGetMountBufferSizeSync) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosArchiveGetMountBufferSizeSync, const SceFiosOpAttr *pAttr, const char *pArchivePath, const void *pOpenParams) {
+    if (!pArchivePath)
+        return SCE_FIOS_ERROR_BAD_PATH;
+
+    const int res = fios_get_archive_mount_size(emuenv.io, pArchivePath, emuenv.pref_path, export_name);
+    return res < 0 ? to_fios_error(res) : res;
 }
 
-EXPORT(int, sceFiosArchiveMount) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosArchiveMountSync, const SceFiosOpAttr *pAttr, SceFiosFH *pOutFH, const char *pArchivePath, const char *pMountPoint, Ptr<void> mountBuffer, SceSize mountBufferLength, const void *pParams) {
+    if (!pOutFH)
+        return SCE_FIOS_ERROR_BAD_PTR;
+    if (!pArchivePath || !pMountPoint)
+        return SCE_FIOS_ERROR_BAD_PATH;
+
+    // the table of content is kept on the host, the mount buffer is left unused
+    const SceUID fh = fios_mount_archive(emuenv.io, pArchivePath, pMountPoint, emuenv.pref_path, export_name);
+    if (fh < 0)
+        return to_fios_error(fh);
+
+    *pOutFH = fh;
+    return SCE_FIOS_OK;
 }
 
-EXPORT(int, sceFiosArchiveMountSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosArchiveMount, const SceFiosOpAttr *pAttr, SceFiosFH *pOutFH, const char *pArchivePath, const char *pMountPoint, Ptr<void> mountBuffer, SceSize mountBufferLength, const void *pParams) {
+    // mounting modifies the file tables, so it is done right away and only the completion is asynchronous
+    const int res = CALL_EXPORT(sceFiosArchiveMountSync, pAttr, pOutFH, pArchivePath, pMountPoint, mountBuffer, mountBufferLength, pParams);
+    return complete_op(emuenv, thread_id, export_name, pAttr, res);
 }
 
-EXPORT(int, sceFiosArchiveSetDecompressorThreadCount) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosArchiveSetDecompressorThreadCount, int threadCount) {
+    if (threadCount < 0)
+        return SCE_FIOS_ERROR_BAD_SIZE;
+
+    return static_cast<int>(fios_set_decompressor_thread_count(emuenv.io, threadCount));
 }
 
-EXPORT(int, sceFiosArchiveUnmount) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosArchiveUnmountSync, const SceFiosOpAttr *pAttr, SceFiosFH fh) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    if (!file || !file->mount_point)
+        return SCE_FIOS_ERROR_BAD_FH;
+
+    LOG_INFO("{}: Unmounting archive {}", export_name, file->path);
+    const int res = fios_close_file(emuenv.io, fh, export_name);
+    return res < 0 ? to_fios_error(res) : SCE_FIOS_OK;
 }
 
-EXPORT(int, sceFiosArchiveUnmountSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosArchiveUnmount, const SceFiosOpAttr *pAttr, SceFiosFH fh) {
+    const int res = CALL_EXPORT(sceFiosArchiveUnmountSync, pAttr, fh);
+    return complete_op(emuenv, thread_id, export_name, pAttr, res);
 }
 
-EXPORT(int, sceFiosCacheContainsFileRangeSync) {
-    return UNIMPLEMENTED();
+EXPORT(bool, sceFiosCacheContainsFileRangeSync, const SceFiosOpAttr *pAttr, const char *pPath, SceFiosOffset startOffset, SceFiosSize length) {
+    return with_file(emuenv, export_name, pPath, [&](const std::shared_ptr<FiosFile> &file) -> SceOff {
+        return fios_cache_contains(emuenv.io, *file, startOffset, length);
+    }) > 0;
 }
 
-EXPORT(int, sceFiosCacheContainsFileSync) {
-    return UNIMPLEMENTED();
+EXPORT(bool, sceFiosCacheContainsFileSync, const SceFiosOpAttr *pAttr, const char *pPath) {
+    return CALL_EXPORT(sceFiosCacheContainsFileRangeSync, pAttr, pPath, 0, -1);
 }
 
-EXPORT(int, sceFiosCacheFlushFileRangeSync) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosCacheFlushFileRangeSync, const SceFiosOpAttr *pAttr, const char *pPath, SceFiosOffset startOffset, SceFiosSize length) {
+    return static_cast<int>(with_file(emuenv, export_name, pPath, [&](const std::shared_ptr<FiosFile> &file) -> SceOff {
+        fios_cache_flush(emuenv.io, file.get(), startOffset, length);
+        return SCE_FIOS_OK;
+    }));
 }
 
-EXPORT(int, sceFiosCacheFlushFileSync) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosCacheFlushFileSync, const SceFiosOpAttr *pAttr, const char *pPath) {
+    return CALL_EXPORT(sceFiosCacheFlushFileRangeSync, pAttr, pPath, 0, -1);
 }
 
 EXPORT(int, sceFiosCacheFlushSync) {
-    return UNIMPLEMENTED();
+    fios_cache_flush(emuenv.io, nullptr);
+    return SCE_FIOS_OK;
 }
 
-EXPORT(int, sceFiosCachePrefetchFH) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosCachePrefetchFHRange, const SceFiosOpAttr *pAttr, SceFiosFH fh, SceFiosOffset startOffset, SceFiosSize length) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    if (!file)
+        return complete_op(emuenv, thread_id, export_name, pAttr, SCE_FIOS_ERROR_BAD_FH);
+    if (startOffset < 0)
+        return complete_op(emuenv, thread_id, export_name, pAttr, SCE_FIOS_ERROR_BAD_OFFSET);
+
+    IOState &io = emuenv.io;
+    return start_op(emuenv, thread_id, export_name, pAttr, length, [&io, file, startOffset, length]() {
+        return prefetch_fh(io, file, startOffset, length);
+    });
 }
 
-EXPORT(int, sceFiosCachePrefetchFHRange) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosCachePrefetchFH, const SceFiosOpAttr *pAttr, SceFiosFH fh) {
+    return CALL_EXPORT(sceFiosCachePrefetchFHRange, pAttr, fh, 0, -1);
 }
 
-EXPORT(int, sceFiosCachePrefetchFHRangeSync) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosCachePrefetchFHRangeSync, const SceFiosOpAttr *pAttr, SceFiosFH fh, SceFiosOffset startOffset, SceFiosSize length) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    if (!file)
+        return SCE_FIOS_ERROR_BAD_FH;
+    if (startOffset < 0)
+        return SCE_FIOS_ERROR_BAD_OFFSET;
+
+    return static_cast<int>(prefetch_fh(emuenv.io, file, startOffset, length));
 }
 
-EXPORT(int, sceFiosCachePrefetchFHSync) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosCachePrefetchFHSync, const SceFiosOpAttr *pAttr, SceFiosFH fh) {
+    return CALL_EXPORT(sceFiosCachePrefetchFHRangeSync, pAttr, fh, 0, -1);
 }
 
-EXPORT(int, sceFiosCachePrefetchFile) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosCachePrefetchFileRange, const SceFiosOpAttr *pAttr, const char *pPath, SceFiosOffset startOffset, SceFiosSize length) {
+    if (startOffset < 0)
+        return complete_op(emuenv, thread_id, export_name, pAttr, SCE_FIOS_ERROR_BAD_OFFSET);
+
+    SceFiosOp op = SCE_FIOS_OP_INVALID;
+    // the operation keeps the handle, so the file can be closed right after queuing it
+    const SceOff res = with_file(emuenv, export_name, pPath, [&](const std::shared_ptr<FiosFile> &file) -> SceOff {
+        IOState &io = emuenv.io;
+        op = start_op(emuenv, thread_id, export_name, pAttr, length, [&io, file, startOffset, length]() {
+            return prefetch_fh(io, file, startOffset, length);
+        });
+        return SCE_FIOS_OK;
+    });
+
+    return res < 0 ? complete_op(emuenv, thread_id, export_name, pAttr, res) : op;
 }
 
-EXPORT(int, sceFiosCachePrefetchFileRange) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosCachePrefetchFile, const SceFiosOpAttr *pAttr, const char *pPath) {
+    return CALL_EXPORT(sceFiosCachePrefetchFileRange, pAttr, pPath, 0, -1);
 }
 
 EXPORT(int, sceFiosCancelAllOps) {
-    return UNIMPLEMENTED();
+    const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+    for (const auto &[id, op] : emuenv.io.fios.ops)
+        op->cancelled = true;
+
+    return SCE_FIOS_OK;
 }
 
 EXPORT(int, sceFiosChangeStat) {
@@ -229,20 +524,37 @@ EXPORT(int, sceFiosDirectoryExistsSync) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosExists) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosExistsSync, const SceFiosOpAttr *pAttr, const char *pPath, bool *pOutExists) {
+    if (!pOutExists)
+        return SCE_FIOS_ERROR_BAD_PTR;
+    if (!pPath)
+        return SCE_FIOS_ERROR_BAD_PATH;
+
+    *pOutExists = with_file(emuenv, export_name, pPath, [](const std::shared_ptr<FiosFile> &) -> SceOff { return SCE_FIOS_OK; }) == SCE_FIOS_OK;
+    if (!*pOutExists) {
+        const SceUID dir = open_dir(emuenv.io, resolve_path(emuenv.io, pPath).c_str(), emuenv.pref_path, export_name);
+        *pOutExists = dir >= 0;
+        if (dir >= 0)
+            close_dir(emuenv.io, dir, export_name);
+    }
+
+    return SCE_FIOS_OK;
 }
 
-EXPORT(int, sceFiosExistsSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosExists, const SceFiosOpAttr *pAttr, const char *pPath, bool *pOutExists) {
+    const int res = CALL_EXPORT(sceFiosExistsSync, pAttr, pPath, pOutExists);
+    return complete_op(emuenv, thread_id, export_name, pAttr, res);
 }
 
-EXPORT(int, sceFiosFHClose) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosFHCloseSync, const SceFiosOpAttr *pAttr, SceFiosFH fh) {
+    const int res = fios_close_file(emuenv.io, fh, export_name);
+    return res < 0 ? to_fios_error(res) : SCE_FIOS_OK;
 }
 
-EXPORT(int, sceFiosFHCloseSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosFHClose, const SceFiosOpAttr *pAttr, SceFiosFH fh) {
+    // the operations already queued keep their handle, so closing does not need to wait for them
+    const int res = CALL_EXPORT(sceFiosFHCloseSync, pAttr, fh);
+    return complete_op(emuenv, thread_id, export_name, pAttr, res);
 }
 
 EXPORT(int, sceFiosFHGetOpenParams) {
@@ -253,8 +565,12 @@ EXPORT(int, sceFiosFHGetPath) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosFHGetSize) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosSize, sceFiosFHGetSize, SceFiosFH fh) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    if (!file)
+        return SCE_FIOS_ERROR_BAD_FH;
+
+    return file->size;
 }
 
 EXPORT(int, sceFiosFHIoctl) {
@@ -265,28 +581,42 @@ EXPORT(int, sceFiosFHIoctlSync) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosFHOpen) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosFHOpen, const SceFiosOpAttr *pAttr, SceFiosFH *pOutFH, const char *pPath, const SceFiosOpenParams *pOpenParams) {
+    // opening modifies the file tables, so it is done right away and only the completion is asynchronous
+    return complete_op(emuenv, thread_id, export_name, pAttr, open_fh(emuenv, export_name, pOutFH, pPath, pOpenParams));
 }
 
-EXPORT(int, sceFiosFHOpenSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosFHOpenWithMode, const SceFiosOpAttr *pAttr, SceFiosFH *pOutFH, const char *pPath, const SceFiosOpenParams *pOpenParams, int32_t nativeMode) {
+    return CALL_EXPORT(sceFiosFHOpen, pAttr, pOutFH, pPath, pOpenParams);
 }
 
-EXPORT(int, sceFiosFHOpenWithMode) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosFHOpenSync, const SceFiosOpAttr *pAttr, SceFiosFH *pOutFH, const char *pPath, const SceFiosOpenParams *pOpenParams) {
+    return static_cast<int>(open_fh(emuenv, export_name, pOutFH, pPath, pOpenParams));
 }
 
-EXPORT(int, sceFiosFHOpenWithModeSync) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosFHOpenWithModeSync, const SceFiosOpAttr *pAttr, SceFiosFH *pOutFH, const char *pPath, const SceFiosOpenParams *pOpenParams, int32_t nativeMode) {
+    return CALL_EXPORT(sceFiosFHOpenSync, pAttr, pOutFH, pPath, pOpenParams);
 }
 
-EXPORT(int, sceFiosFHPread) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosFHPread, const SceFiosOpAttr *pAttr, SceFiosFH fh, void *pBuf, SceFiosSize length, SceFiosOffset offset) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    const SceOff res = check_read(file, pBuf, length, offset);
+    if (res < 0)
+        return complete_op(emuenv, thread_id, export_name, pAttr, res);
+
+    IOState &io = emuenv.io;
+    return start_op(emuenv, thread_id, export_name, pAttr, length, [&io, file, pBuf, length, offset]() {
+        return read_fh(io, file, pBuf, length, offset);
+    });
 }
 
-EXPORT(int, sceFiosFHPreadSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosSize, sceFiosFHPreadSync, const SceFiosOpAttr *pAttr, SceFiosFH fh, void *pBuf, SceFiosSize length, SceFiosOffset offset) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    const SceOff res = check_read(file, pBuf, length, offset);
+    if (res < 0)
+        return res;
+
+    return read_fh(emuenv.io, file, pBuf, length, offset);
 }
 
 EXPORT(int, sceFiosFHPreadv) {
@@ -313,12 +643,26 @@ EXPORT(int, sceFiosFHPwritevSync) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosFHRead) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosFHRead, const SceFiosOpAttr *pAttr, SceFiosFH fh, void *pBuf, SceFiosSize length) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    const SceOff res = check_read(file, pBuf, length, 0);
+    if (res < 0)
+        return complete_op(emuenv, thread_id, export_name, pAttr, res);
+
+    IOState &io = emuenv.io;
+    const SceFiosOffset offset = advance_position(io, *file, length);
+    return start_op(emuenv, thread_id, export_name, pAttr, length, [&io, file, pBuf, length, offset]() {
+        return read_fh(io, file, pBuf, length, offset);
+    });
 }
 
-EXPORT(int, sceFiosFHReadSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosSize, sceFiosFHReadSync, const SceFiosOpAttr *pAttr, SceFiosFH fh, void *pBuf, SceFiosSize length) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    const SceOff res = check_read(file, pBuf, length, 0);
+    if (res < 0)
+        return res;
+
+    return read_fh(emuenv.io, file, pBuf, length, advance_position(emuenv.io, *file, length));
 }
 
 EXPORT(int, sceFiosFHReadv) {
@@ -329,8 +673,25 @@ EXPORT(int, sceFiosFHReadvSync) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosFHSeek) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOffset, sceFiosFHSeek, SceFiosFH fh, SceFiosOffset offset, SceFiosWhence whence) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    if (!file)
+        return SCE_FIOS_ERROR_BAD_FH;
+
+    const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+    SceFiosOffset position = offset;
+    if (whence == SCE_FIOS_SEEK_CUR)
+        position += file->position;
+    else if (whence == SCE_FIOS_SEEK_END)
+        position += file->size;
+    else if (whence != SCE_FIOS_SEEK_SET)
+        return SCE_FIOS_ERROR_BAD_OFFSET;
+
+    if (position < 0)
+        return SCE_FIOS_ERROR_BAD_OFFSET;
+
+    file->position = position;
+    return position;
 }
 
 EXPORT(int, sceFiosFHStat) {
@@ -349,8 +710,13 @@ EXPORT(int, sceFiosFHSyncSync) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosFHTell) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOffset, sceFiosFHTell, SceFiosFH fh) {
+    const std::shared_ptr<FiosFile> file = fios_get_file(emuenv.io, fh);
+    if (!file)
+        return SCE_FIOS_ERROR_BAD_FH;
+
+    const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+    return file->position;
 }
 
 EXPORT(int, sceFiosFHToFileno) {
@@ -389,28 +755,58 @@ EXPORT(int, sceFiosFileDeleteSync) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosFileExists) {
-    return UNIMPLEMENTED();
+EXPORT(bool, sceFiosFileExistsSync, const SceFiosOpAttr *pAttr, const char *pPath) {
+    return with_file(emuenv, export_name, pPath, [](const std::shared_ptr<FiosFile> &) -> SceOff { return SCE_FIOS_OK; }) == SCE_FIOS_OK;
 }
 
-EXPORT(int, sceFiosFileExistsSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosFileExists, const SceFiosOpAttr *pAttr, const char *pPath, bool *pOutExists) {
+    if (!pOutExists)
+        return complete_op(emuenv, thread_id, export_name, pAttr, SCE_FIOS_ERROR_BAD_PTR);
+
+    *pOutExists = CALL_EXPORT(sceFiosFileExistsSync, pAttr, pPath);
+    return complete_op(emuenv, thread_id, export_name, pAttr, SCE_FIOS_OK);
 }
 
-EXPORT(int, sceFiosFileGetSize) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosSize, sceFiosFileGetSizeSync, const SceFiosOpAttr *pAttr, const char *pPath) {
+    return with_file(emuenv, export_name, pPath, [](const std::shared_ptr<FiosFile> &file) -> SceOff { return file->size; });
 }
 
-EXPORT(int, sceFiosFileGetSizeSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosFileGetSize, const SceFiosOpAttr *pAttr, const char *pPath, SceFiosSize *pOutSize) {
+    if (!pOutSize)
+        return complete_op(emuenv, thread_id, export_name, pAttr, SCE_FIOS_ERROR_BAD_PTR);
+
+    const SceFiosSize res = CALL_EXPORT(sceFiosFileGetSizeSync, pAttr, pPath);
+    if (res >= 0)
+        *pOutSize = res;
+
+    return complete_op(emuenv, thread_id, export_name, pAttr, res < 0 ? res : SCE_FIOS_OK);
 }
 
-EXPORT(int, sceFiosFileRead) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosOp, sceFiosFileRead, const SceFiosOpAttr *pAttr, const char *pPath, void *pBuf, SceFiosSize length, SceFiosOffset offset) {
+    SceFiosOp op = SCE_FIOS_OP_INVALID;
+    const SceOff res = with_file(emuenv, export_name, pPath, [&](const std::shared_ptr<FiosFile> &file) -> SceOff {
+        const SceOff res = check_read(file, pBuf, length, offset);
+        if (res < 0)
+            return res;
+
+        IOState &io = emuenv.io;
+        op = start_op(emuenv, thread_id, export_name, pAttr, length, [&io, file, pBuf, length, offset]() {
+            return read_fh(io, file, pBuf, length, offset);
+        });
+        return SCE_FIOS_OK;
+    });
+
+    return res < 0 ? complete_op(emuenv, thread_id, export_name, pAttr, res) : op;
 }
 
-EXPORT(int, sceFiosFileReadSync) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosSize, sceFiosFileReadSync, const SceFiosOpAttr *pAttr, const char *pPath, void *pBuf, SceFiosSize length, SceFiosOffset offset) {
+    return with_file(emuenv, export_name, pPath, [&](const std::shared_ptr<FiosFile> &file) -> SceOff {
+        const SceOff res = check_read(file, pBuf, length, offset);
+        if (res < 0)
+            return res;
+
+        return read_fh(emuenv.io, file, pBuf, length, offset);
+    });
 }
 
 EXPORT(int, sceFiosFileTruncate) {
@@ -477,36 +873,57 @@ EXPORT(int, sceFiosIOFilterRemove) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosInitialize) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosInitialize, const void *pParameters) {
+    const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+    emuenv.io.fios.initialized = true;
+    return SCE_FIOS_OK;
 }
 
-EXPORT(int, sceFiosIsIdle) {
-    return UNIMPLEMENTED();
+EXPORT(bool, sceFiosIsIdle) {
+    const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+    for (const auto &[id, op] : emuenv.io.fios.ops) {
+        if (!op->done)
+            return false;
+    }
+
+    return true;
 }
 
-EXPORT(int, sceFiosIsInitialized) {
-    return UNIMPLEMENTED();
+EXPORT(bool, sceFiosIsInitialized, void *pOutParameters) {
+    const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+    return emuenv.io.fios.initialized;
 }
 
 EXPORT(int, sceFiosIsSuspended) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosIsValidHandle) {
-    return UNIMPLEMENTED();
+EXPORT(bool, sceFiosIsValidHandle, SceFiosFH fh) {
+    return fios_get_file(emuenv.io, fh) != nullptr;
 }
 
-EXPORT(int, sceFiosOpCancel) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosOpCancel, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    if (!fios_op)
+        return SCE_FIOS_ERROR_BAD_OP;
+
+    // only the operations which have not started yet are cancelled
+    fios_op->cancelled = true;
+    return SCE_FIOS_OK;
 }
 
-EXPORT(int, sceFiosOpDelete) {
-    return UNIMPLEMENTED();
+EXPORT(void, sceFiosOpDelete, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    if (fios_op)
+        delete_op(emuenv, thread_id, export_name, *fios_op);
 }
 
-EXPORT(int, sceFiosOpGetActualCount) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosSize, sceFiosOpGetActualCount, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    if (!fios_op)
+        return SCE_FIOS_ERROR_BAD_OP;
+
+    return fios_op->done ? fios_op->actual_count : 0;
 }
 
 EXPORT(int, sceFiosOpGetAttr) {
@@ -517,8 +934,12 @@ EXPORT(int, sceFiosOpGetBuffer) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosOpGetError) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosOpGetError, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    if (!fios_op)
+        return SCE_FIOS_ERROR_BAD_OP;
+
+    return fios_op->done ? fios_op->error : SCE_FIOS_OK;
 }
 
 EXPORT(int, sceFiosOpGetOffset) {
@@ -529,16 +950,22 @@ EXPORT(int, sceFiosOpGetPath) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosOpGetRequestCount) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosSize, sceFiosOpGetRequestCount, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    if (!fios_op)
+        return SCE_FIOS_ERROR_BAD_OP;
+
+    return fios_op->request_count;
 }
 
-EXPORT(int, sceFiosOpIsCancelled) {
-    return UNIMPLEMENTED();
+EXPORT(bool, sceFiosOpIsCancelled, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    return fios_op && fios_op->cancelled;
 }
 
-EXPORT(int, sceFiosOpIsDone) {
-    return UNIMPLEMENTED();
+EXPORT(bool, sceFiosOpIsDone, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    return fios_op && fios_op->done;
 }
 
 EXPORT(int, sceFiosOpReschedule) {
@@ -549,16 +976,35 @@ EXPORT(int, sceFiosOpRescheduleWithPriority) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosOpSyncWait) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosOpSyncWait, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    if (!fios_op)
+        return SCE_FIOS_ERROR_BAD_OP;
+
+    wait_op(emuenv, thread_id, export_name, *fios_op);
+    const int error = fios_op->error;
+    delete_op(emuenv, thread_id, export_name, *fios_op);
+    return error;
 }
 
-EXPORT(int, sceFiosOpSyncWaitForIO) {
-    return UNIMPLEMENTED();
+EXPORT(SceFiosSize, sceFiosOpSyncWaitForIO, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    if (!fios_op)
+        return SCE_FIOS_ERROR_BAD_OP;
+
+    wait_op(emuenv, thread_id, export_name, *fios_op);
+    const SceFiosSize res = fios_op->error < 0 ? fios_op->error : fios_op->actual_count;
+    delete_op(emuenv, thread_id, export_name, *fios_op);
+    return res;
 }
 
-EXPORT(int, sceFiosOpWait) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosOpWait, SceFiosOp op) {
+    const std::shared_ptr<FiosOp> fios_op = get_op(emuenv, op);
+    if (!fios_op)
+        return SCE_FIOS_ERROR_BAD_OP;
+
+    const int res = wait_op(emuenv, thread_id, export_name, *fios_op);
+    return res < 0 ? res : fios_op->error;
 }
 
 EXPORT(int, sceFiosOpWaitUntil) {
@@ -585,8 +1031,18 @@ EXPORT(int, sceFiosOverlayRemove) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosOverlayResolveSync) {
-    return UNIMPLEMENTED();
+EXPORT(int, sceFiosOverlayResolveSync, int resolveFlag, const char *pInPath, char *pOutPath, SceSize maxPath) {
+    if (!pInPath)
+        return SCE_FIOS_ERROR_BAD_PATH;
+    if (!pOutPath)
+        return SCE_FIOS_ERROR_BAD_PTR;
+
+    const std::string resolved = resolve_path(emuenv.io, pInPath);
+    if (resolved.size() >= maxPath)
+        return SCE_FIOS_ERROR_BAD_SIZE;
+
+    strcpy(pOutPath, resolved.c_str());
+    return SCE_FIOS_OK;
 }
 
 EXPORT(int, sceFiosPathNormalize) {
@@ -665,8 +1121,11 @@ EXPORT(int, sceFiosSyncSync) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiosTerminate) {
-    return UNIMPLEMENTED();
+EXPORT(void, sceFiosTerminate) {
+    fios_terminate(emuenv.io, export_name);
+
+    const std::lock_guard<std::mutex> guard(emuenv.io.fios.mutex);
+    emuenv.io.fios.initialized = false;
 }
 
 EXPORT(int, sceFiosTimeGetCurrent) {
@@ -1020,14 +1020,14 @@ struct SceGxmContext {
 
     void free_command_list(SceGxmCommandList *command_list) {
         // command list has been overwritten, free the memory
-        // everything except the command_list except was allocated using malloc
+        // the commands come from the renderer pool, the list itself was allocated using malloc
         renderer::Command *cmd = command_list->list->first;
         while (cmd != command_list->list->last) {
             renderer::Command *next = cmd->next;
-            free(cmd);
+            renderer::generic_command_free(cmd);
             cmd = next;
         }
-        free(cmd);
+        renderer::generic_command_free(cmd);
         free(command_list->list);
 
         // we also need to delete all ranges occupied by this list
@@ -1122,22 +1122,29 @@ struct SceGxmContext {
         return true;
     }
 
-    std::uint8_t *linearly_allocate(KernelState &kern, const MemState &mem, const SceUID thread_id, const std::uint32_t size) {
-        if (state.type != SCE_GXM_CONTEXT_TYPE_DEFERRED) {
-            return nullptr;
-        }
-
+    bool reserve_vdm_space(KernelState &kern, const MemState &mem, const SceUID thread_id) {
         // allocate 4 bytes in the vdm memory to make it look like the vdm buffer is getting used
         // otherwise we would never know when to free our command lists
         constexpr uint32_t allocated_on_vdm = 4;
 
         if (alloc_space.address() + allocated_on_vdm > alloc_space_end.address()) {
             if (!make_new_alloc_space(kern, mem, thread_id, true)) {
-                return nullptr;
+                return false;
             }
         }
 
         alloc_space = alloc_space + allocated_on_vdm;
+        return true;
+    }
+
+    std::uint8_t *linearly_allocate(KernelState &kern, const MemState &mem, const SceUID thread_id, const std::uint32_t size) {
+        if (state.type != SCE_GXM_CONTEXT_TYPE_DEFERRED) {
+            return nullptr;
+        }
+
+        if (!reserve_vdm_space(kern, mem, thread_id)) {
+            return nullptr;
+        }
 
         // the data returned is not part of the vita memory (our commands are too big and do not fit)
         return static_cast<uint8_t *>(malloc(size));
@@ -1158,13 +1165,13 @@ struct SceGxmContext {
                 new_command = alloc_space.cast<renderer::Command>().get(mem) + offset;
                 new (new_command) renderer::Command;
             } else {
-                new_command = new renderer::Command;
+                new_command = renderer::generic_command_allocate();
                 new_command->flags |= renderer::Command::FLAG_FROM_HOST;
             }
         } else {
-            new_command = linearly_allocate<renderer::Command>(kern, mem, current_thread_id);
-
-            new (new_command) renderer::Command;
+            // the command is only freed once the command list has been overwritten
+            reserve_vdm_space(kern, mem, current_thread_id);
+            new_command = renderer::generic_command_allocate();
             new_command->flags |= renderer::Command::FLAG_NO_FREE;
         }
 
@@ -1174,7 +1181,7 @@ struct SceGxmContext {
     void free_new_command(renderer::Command *cmd) {
         if (!(cmd->flags & renderer::Command::FLAG_NO_FREE)) {
             if (cmd->flags & renderer::Command::FLAG_FROM_HOST) {
-                delete cmd;
+                renderer::generic_command_free(cmd);
             } else {
                 ++command_last_free_pos;
             }
@@ -2653,7 +2660,7 @@ EXPORT(int, sceGxmInitialize, const SceGxmInitializeParams *params) {
     // also, the last frame won't be in the queue so decrease the count by 1
     // the case where displayQueueMaxPendingCount is 1 handled in sceGxmDisplayQueueAddEntry
     const uint32_t max_queue_size = std::max(std::min(params->displayQueueMaxPendingCount, 3U) - 1, 1U);
-    emuenv.gxm.display_queue.maxPendingCount_ = max_queue_size;
+    emuenv.gxm.display_queue.set_capacity(max_queue_size);
 
     const ThreadStatePtr main_thread = emuenv.kernel.get_thread(thread_id);
     const ThreadStatePtr display_queue_thread = emuenv.kernel.create_thread(emuenv.mem, "SceGxmDisplayQueue", Ptr<void>(0), SCE_KERNEL_HIGHEST_PRIORITY_USER, SCE_KERNEL_THREAD_CPU_AFFINITY_MASK_DEFAULT, SCE_KERNEL_STACK_SIZE_USER_DEFAULT, nullptr);
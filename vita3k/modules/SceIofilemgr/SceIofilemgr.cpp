@@ -18,11 +18,41 @@
 #include "SceIofilemgr.h"
 
 #include <io/functions.h>
+#include <kernel/state.h>
+#include <kernel/sync_primitives.h>
 #include <kernel/types.h>
 
 #include <util/tracy.h>
 TRACY_MODULE_NAME(SceIofilemgr);
 
+// An asynchronous operation is a simple event which gets the SCE_KERNEL_EVENT_IN bit once the operation is done,
+// the result of the operation is the user data of the event
+static SceUID create_async_operation(EmuEnvState &emuenv, const SceUID thread_id, const char *export_name) {
+    return simple_event_create(emuenv.kernel, emuenv.mem, export_name, "SceIoAsyncOp", thread_id, SCE_KERNEL_ATTR_TH_FIFO, 0);
+}
+
+static void complete_async_operation(KernelState &kernel, const SceUID thread_id, const SceUID op_id, const SceOff result) {
+    simple_event_setorpulse(kernel, "complete_async_operation", thread_id, op_id, SCE_KERNEL_EVENT_IN, static_cast<SceUInt64>(result), true);
+}
+
+static SceUID read_async(EmuEnvState &emuenv, const SceUID thread_id, const char *export_name, const SceUID fd, void *data, const SceSize size, const std::optional<SceOff> offset) {
+    const SceUID op_id = create_async_operation(emuenv, thread_id, export_name);
+    if (op_id < 0)
+        return op_id;
+
+    KernelState &kernel = emuenv.kernel;
+    const int res = read_file_async(data, emuenv.io, fd, size, offset, [&kernel, thread_id, op_id](SceOff result) {
+        complete_async_operation(kernel, thread_id, op_id, result);
+    },
+        export_name);
+    if (res < 0) {
+        simple_event_delete(emuenv.kernel, export_name, thread_id, op_id);
+        return res;
+    }
+
+    return op_id;
+}
+
 EXPORT(int, _sceIoChstat) {
     TRACY_FUNC(_sceIoChstat);
     return UNIMPLEMENTED();
@@ -120,19 +150,40 @@ EXPORT(int, _sceIoOpen, const char *file, const int flags, const SceMode mode) {
     return open_file(emuenv.io, file, flags, emuenv.pref_path, export_name);
 }
 
-EXPORT(int, _sceIoOpenAsync) {
-    TRACY_FUNC(_sceIoOpenAsync);
-    return UNIMPLEMENTED();
+EXPORT(SceUID, _sceIoOpenAsync, const char *file, const int flags, const SceMode mode) {
+    TRACY_FUNC(_sceIoOpenAsync, file, flags, mode);
+    if (file == nullptr) {
+        return RET_ERROR(SCE_ERROR_ERRNO_EINVAL);
+    }
+
+    const SceUID op_id = create_async_operation(emuenv, thread_id, export_name);
+    if (op_id < 0)
+        return op_id;
+
+    // opening modifies the file table, so it is done right away and only the completion is asynchronous
+    LOG_INFO("Opening file: {}", file);
+    const SceUID fd = open_file(emuenv.io, file, flags, emuenv.pref_path, export_name);
+    complete_async_operation(emuenv.kernel, thread_id, op_id, fd);
+
+    return op_id;
 }
 
-EXPORT(int, _sceIoPread) {
-    TRACY_FUNC(_sceIoPread);
-    return UNIMPLEMENTED();
+EXPORT(int, _sceIoPread, const SceUID fd, void *data, const SceSize size, Ptr<_sceIoPreadOpt> opt) {
+    TRACY_FUNC(_sceIoPread, fd, data, size, opt);
+    if (!data || !opt || opt.get(emuenv.mem)->offset < 0) {
+        return RET_ERROR(SCE_ERROR_ERRNO_EINVAL);
+    }
+
+    return pread_file(data, emuenv.io, fd, size, opt.get(emuenv.mem)->offset, export_name);
 }
 
-EXPORT(int, _sceIoPreadAsync) {
-    TRACY_FUNC(_sceIoPreadAsync);
-    return UNIMPLEMENTED();
+EXPORT(SceUID, _sceIoPreadAsync, const SceUID fd, void *data, const SceSize size, Ptr<_sceIoPreadOpt> opt) {
+    TRACY_FUNC(_sceIoPreadAsync, fd, data, size, opt);
+    if (!data || !opt || opt.get(emuenv.mem)->offset < 0) {
+        return RET_ERROR(SCE_ERROR_ERRNO_EINVAL);
+    }
+
+    return read_async(emuenv, thread_id, export_name, fd, data, size, opt.get(emuenv.mem)->offset);
 }
 
 EXPORT(int, _sceIoPwrite) {
@@ -205,9 +256,16 @@ EXPORT(int, sceIoCloseAsync) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceIoComplete) {
-    TRACY_FUNC(sceIoComplete);
-    return UNIMPLEMENTED();
+EXPORT(int, sceIoComplete, const SceUID op_id) {
+    TRACY_FUNC(sceIoComplete, op_id);
+    // wait for the operation to be done and release it
+    SceUInt64 result = 0;
+    const SceInt32 res = simple_event_waitorpoll(emuenv.kernel, export_name, thread_id, op_id, SCE_KERNEL_EVENT_IN, nullptr, &result, nullptr, true);
+    if (res < 0)
+        return res;
+
+    simple_event_delete(emuenv.kernel, export_name, thread_id, op_id);
+    return static_cast<int>(result);
 }
 
 EXPORT(int, sceIoDclose, const SceUID fd) {
@@ -275,9 +333,13 @@ EXPORT(int, sceIoRead, const SceUID fd, void *data, const SceSize size) {
     return read_file(data, emuenv.io, fd, size, export_name);
 }
 
-EXPORT(int, sceIoReadAsync) {
-    TRACY_FUNC(sceIoReadAsync);
-    return UNIMPLEMENTED();
+EXPORT(SceUID, sceIoReadAsync, const SceUID fd, void *data, const SceSize size) {
+    TRACY_FUNC(sceIoReadAsync, fd, data, size);
+    if (!data) {
+        return RET_ERROR(SCE_ERROR_ERRNO_EINVAL);
+    }
+
+    return read_async(emuenv, thread_id, export_name, fd, data, size, std::nullopt);
 }
 
 EXPORT(int, sceIoSetPriority) {
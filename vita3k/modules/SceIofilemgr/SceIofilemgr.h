@@ -26,8 +26,16 @@ typedef struct _sceIoLseekOpt {
     uint32_t unk;
 } _sceIoLseekOpt;
 
+typedef struct _sceIoPreadOpt {
+    SceOff offset;
+    uint32_t unk[2];
+} _sceIoPreadOpt;
+
 DECL_EXPORT(int, _sceIoDopen, const char *dir);
 DECL_EXPORT(int, _sceIoDread, const SceUID fd, SceIoDirent *dir);
 DECL_EXPORT(int, _sceIoMkdir, const char *dir, const SceMode mode);
 DECL_EXPORT(SceOff, _sceIoLseek, const SceUID fd, Ptr<_sceIoLseekOpt> opt);
+DECL_EXPORT(SceUID, _sceIoOpenAsync, const char *file, const int flags, const SceMode mode);
+DECL_EXPORT(int, _sceIoPread, const SceUID fd, void *data, const SceSize size, Ptr<_sceIoPreadOpt> opt);
+DECL_EXPORT(SceUID, _sceIoPreadAsync, const SceUID fd, void *data, const SceSize size, Ptr<_sceIoPreadOpt> opt);
 DECL_EXPORT(int, _sceIoGetstat, const char *file, SceIoStat *stat);
@@ -635,26 +635,32 @@ EXPORT(SceUID, sceIoOpen, const char *file, const int flags, const SceMode mode)
     return open_file(emuenv.io, file, flags, emuenv.pref_path, export_name);
 }
 
-EXPORT(int, sceIoOpenAsync) {
-    TRACY_FUNC(sceIoOpenAsync);
-    return UNIMPLEMENTED();
+EXPORT(SceUID, sceIoOpenAsync, const char *file, const int flags, const SceMode mode) {
+    TRACY_FUNC(sceIoOpenAsync, file, flags, mode);
+    if (emuenv.cfg.current_config.file_loading_delay > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(emuenv.cfg.current_config.file_loading_delay));
+
+    return CALL_EXPORT(_sceIoOpenAsync, file, flags, mode);
 }
 
 EXPORT(SceSSize, sceIoPread, SceUID fd, void *buf, SceSize nbyte, SceOff offset) {
     TRACY_FUNC(sceIoPread, fd, buf, nbyte, offset);
-    auto pos = tell_file(emuenv.io, fd, export_name);
-    if (pos < 0) {
-        return static_cast<SceSSize>(pos);
+    if (buf == nullptr || offset < 0) {
+        return RET_ERROR(SCE_ERROR_ERRNO_EINVAL);
     }
-    seek_file(fd, offset, SCE_SEEK_SET, emuenv.io, export_name);
-    const auto res = read_file(buf, emuenv.io, fd, nbyte, export_name);
-    seek_file(fd, pos, SCE_SEEK_SET, emuenv.io, export_name);
-    return res;
+
+    return pread_file(buf, emuenv.io, fd, nbyte, offset, export_name);
 }
 
-EXPORT(int, sceIoPreadAsync) {
-    TRACY_FUNC(sceIoPreadAsync);
-    return UNIMPLEMENTED();
+EXPORT(SceUID, sceIoPreadAsync, SceUID fd, void *buf, SceSize nbyte, SceOff offset) {
+    TRACY_FUNC(sceIoPreadAsync, fd, buf, nbyte, offset);
+    const ThreadStatePtr thread = emuenv.kernel.get_thread(thread_id);
+
+    Ptr<_sceIoPreadOpt> options = Ptr<_sceIoPreadOpt>(stack_alloc(*thread->cpu, sizeof(_sceIoPreadOpt)));
+    options.get(emuenv.mem)->offset = offset;
+    const SceUID res = CALL_EXPORT(_sceIoPreadAsync, fd, buf, nbyte, options);
+    stack_free(*thread->cpu, sizeof(_sceIoPreadOpt));
+    return res;
 }
 
 EXPORT(SceSSize, sceIoPwrite, SceUID fd, const void *buf, SceSize nbyte, SceOff offset) {
@@ -38,6 +38,8 @@
 #include <util/log.h>
 #include <util/string_utils.h>
 
+#include <array>
+#include <bit>
 #include <unordered_set>
 
 static constexpr bool LOG_UNK_NIDS_ALWAYS = false;
@@ -54,18 +56,62 @@ static constexpr bool LOG_UNK_NIDS_ALWAYS = false;
 
 struct EmuEnvState;
 
-static const ImportFn *resolve_import(uint32_t nid) {
-    switch (nid) {
+struct ImportEntry {
+    uint32_t nid = 0;
+    const ImportFn *fn = nullptr;
+};
+
+/**
+ * \brief Open addressing hash table of all the HLE functions, built once from nids.inc.
+ *
+ * The table is kept at most half full, so a lookup is a multiplication and almost always a single
+ * probe, instead of the binary search generated for the switch over all the NIDs.
+ */
+class ImportTable {
+public:
+    ImportTable() {
+        static const ImportEntry entries[] = {
 #define VAR_NID(name, nid)
-#define NID(name, nid) \
-    case nid:          \
-        return &import_##name;
+#define NID(name, nid) { nid, &import_##name },
 #include <nids/nids.inc>
 #undef NID
 #undef VAR_NID
-    default:
-        return nullptr;
+        };
+
+        const size_t capacity = std::bit_ceil(std::size(entries) * 2);
+        shift = 32 - std::countr_zero(capacity);
+        mask = capacity - 1;
+        table.resize(capacity);
+        for (const ImportEntry &entry : entries) {
+            size_t index = hash(entry.nid);
+            while (table[index].fn)
+                index = (index + 1) & mask;
+            table[index] = entry;
+        }
     }
+
+    const ImportFn *find(uint32_t nid) const {
+        for (size_t index = hash(nid);; index = (index + 1) & mask) {
+            const ImportEntry &entry = table[index];
+            if (!entry.fn || entry.nid == nid)
+                return entry.fn;
+        }
+    }
+
+private:
+    size_t hash(uint32_t nid) const {
+        // Fibonacci hashing, the NIDs are already well distributed but this is cheap insurance
+        return (nid * 0x9E3779B1u) >> shift;
+    }
+
+    std::vector<ImportEntry> table;
+    uint32_t shift = 0;
+    size_t mask = 0;
+};
+
+static const ImportFn *resolve_import(uint32_t nid) {
+    static const ImportTable import_table;
+    return import_table.find(nid);
 }
 
 struct VarExport {
@@ -133,7 +179,14 @@ void call_import(EmuEnvState &emuenv, CPUState &cpu, uint32_t nid, SceUID thread
     }
     const ImportFn *fn = resolve_import(nid);
     if (fn) {
-        (*fn)(emuenv, cpu, thread_id);
+        ImportProfiler &profiler = emuenv.kernel.debugger.import_profiler;
+        if (profiler.is_enabled()) {
+            profiler.begin_call(nid);
+            (*fn)(emuenv, cpu, thread_id);
+            profiler.end_call(nid, thread_id);
+        } else {
+            (*fn)(emuenv, cpu, thread_id);
+        }
     } else {
         const ThreadStatePtr thread = emuenv.kernel.get_thread(thread_id);
         // make the function return 0
@@ -171,22 +224,14 @@ SceUID load_module(EmuEnvState &emuenv, const std::string &module_path) {
 
     if (emuenv.io.case_isens_find_enabled && !fs::exists(system_path)) {
         // Attempt a case-insensitive file search.
-        const auto original_translated_module_path = translated_module_path;
-        const auto cached_path = find_in_cache(emuenv.io, string_utils::tolower(translated_module_path.string()));
-        if (!cached_path.empty()) {
-            translated_module_path = cached_path;
-            LOG_TRACE("Found cached filepath at {}", translated_module_path);
+        const auto found_path = find_case_isens_path(emuenv.io, device_for_icase, translated_module_path, system_path);
+        if (!found_path.empty()) {
+            LOG_TRACE("Found file on case-sensitive filesystem at {}", found_path);
+            translated_module_path = found_path.string().substr(emuenv.pref_path.string().length());
+            translated_module_path = translated_module_path.string().substr(translated_module_path.string().find('/') + 1);
         } else {
-            const bool path_found = find_case_isens_path(emuenv.io, device_for_icase, translated_module_path, system_path);
-            translated_module_path = find_in_cache(emuenv.io, string_utils::tolower(system_path.string()));
-            if (!translated_module_path.empty() && path_found) {
-                LOG_TRACE("Found file on case-sensitive filesystem at {}", translated_module_path);
-                translated_module_path = translated_module_path.string().substr(emuenv.pref_path.string().length());
-                translated_module_path = translated_module_path.string().substr(translated_module_path.string().find('/') + 1);
-            } else {
-                LOG_ERROR("Missing file at {} (target path: {})", original_translated_module_path.string(), module_path);
-                return SCE_ERROR_ERRNO_ENOENT;
-            }
+            LOG_ERROR("Missing file at {} (target path: {})", translated_module_path.string(), module_path);
+            return SCE_ERROR_ERRNO_ENOENT;
         }
     }
 
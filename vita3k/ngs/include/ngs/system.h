@@ -116,6 +116,9 @@ public:
     virtual bool process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) = 0;
     virtual uint32_t module_id() const { return 0; }
     virtual uint32_t get_buffer_parameter_size() const = 0;
+    // False if process may invoke a guest callback or uses state shared by all the voices of the rack,
+    // in which case the voices using this module are processed one after the other on the guest thread
+    virtual bool can_process_concurrently() const { return true; }
     virtual void on_state_change(const MemState &mem, ModuleData &v, const VoiceState previous) {}
     virtual void on_param_change(const MemState &mem, ModuleData &data) {}
 };
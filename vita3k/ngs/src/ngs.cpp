@@ -24,6 +24,12 @@
 
 #include <util/vector_utils.h>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+
 namespace ngs {
 Rack::Rack(System *mama, const Ptr<void> memspace, const uint32_t memspace_size)
     : MempoolObject(memspace, memspace_size)
@@ -60,6 +66,50 @@ VoiceInputManager::PCMInput *VoiceInputManager::get_input_buffer_queue(const int
     return &inputs[index];
 }
 
+// mix interleaved stereo samples into dest using the volume matrix, then clamp the result
+static void mix_stereo(float *dest, const float *src, const float (&volume_matrix)[2][2], const int32_t sample_count) {
+    int32_t k = 0;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    // two stereo samples at a time: dest += src.left * (m00, m01) + src.right * (m10, m11)
+    const __m128 left_volume = _mm_setr_ps(volume_matrix[0][0], volume_matrix[0][1], volume_matrix[0][0], volume_matrix[0][1]);
+    const __m128 right_volume = _mm_setr_ps(volume_matrix[1][0], volume_matrix[1][1], volume_matrix[1][0], volume_matrix[1][1]);
+    const __m128 min_value = _mm_set1_ps(-1.0f);
+    const __m128 max_value = _mm_set1_ps(1.0f);
+    for (; k + 2 <= sample_count; k += 2) {
+        const __m128 input = _mm_loadu_ps(src + k * 2);
+        const __m128 left = _mm_shuffle_ps(input, input, _MM_SHUFFLE(2, 2, 0, 0));
+        const __m128 right = _mm_shuffle_ps(input, input, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 result = _mm_add_ps(_mm_loadu_ps(dest + k * 2), _mm_mul_ps(left, left_volume));
+        result = _mm_add_ps(result, _mm_mul_ps(right, right_volume));
+        // the constants go first: minps and maxps return their second operand when one is NaN, which keeps NaN like std::clamp
+        _mm_storeu_ps(dest + k * 2, _mm_min_ps(max_value, _mm_max_ps(min_value, result)));
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    const float left_values[4] = { volume_matrix[0][0], volume_matrix[0][1], volume_matrix[0][0], volume_matrix[0][1] };
+    const float right_values[4] = { volume_matrix[1][0], volume_matrix[1][1], volume_matrix[1][0], volume_matrix[1][1] };
+    const float32x4_t left_volume = vld1q_f32(left_values);
+    const float32x4_t right_volume = vld1q_f32(right_values);
+    const float32x4_t min_value = vdupq_n_f32(-1.0f);
+    const float32x4_t max_value = vdupq_n_f32(1.0f);
+    for (; k + 2 <= sample_count; k += 2) {
+        const float32x4_t input = vld1q_f32(src + k * 2);
+        const float32x4_t left = vtrn1q_f32(input, input);
+        const float32x4_t right = vtrn2q_f32(input, input);
+        float32x4_t result = vaddq_f32(vld1q_f32(dest + k * 2), vmulq_f32(left, left_volume));
+        result = vaddq_f32(result, vmulq_f32(right, right_volume));
+        vst1q_f32(dest + k * 2, vminq_f32(vmaxq_f32(result, min_value), max_value));
+    }
+#endif
+
+    for (; k < sample_count; k++) {
+        dest[k * 2] = std::clamp(dest[k * 2] + src[k * 2] * volume_matrix[0][0]
+                + src[k * 2 + 1] * volume_matrix[1][0],
+            -1.0f, 1.0f);
+        dest[k * 2 + 1] = std::clamp(dest[k * 2 + 1] + src[k * 2] * volume_matrix[0][1] + src[k * 2 + 1] * volume_matrix[1][1], -1.0f, 1.0f);
+    }
+}
+
 int32_t VoiceInputManager::receive(ngs::Patch *patch, const VoiceProduct &product) {
     PCMInput *input = get_input_buffer_queue(patch->dest_index);
 
@@ -86,12 +136,7 @@ int32_t VoiceInputManager::receive(ngs::Patch *patch, const VoiceProduct &produc
 
     // Try mixing, also with the use of this volume matrix
     // Dest is our voice to receive this data.
-    for (int32_t k = 0; k < patch->dest->rack->system->granularity; k++) {
-        dest_buffer[k * 2] = std::clamp(dest_buffer[k * 2] + data_to_mix_in[k * 2] * volume_matrix[0][0]
-                + data_to_mix_in[k * 2 + 1] * volume_matrix[1][0],
-            -1.0f, 1.0f);
-        dest_buffer[k * 2 + 1] = std::clamp(dest_buffer[k * 2 + 1] + data_to_mix_in[k * 2] * volume_matrix[0][1] + data_to_mix_in[k * 2 + 1] * volume_matrix[1][1], -1.0f, 1.0f);
-    }
+    mix_stereo(dest_buffer, data_to_mix_in, volume_matrix, patch->dest->rack->system->granularity);
 
     return 0;
 }
@@ -22,6 +22,8 @@
 
 #include <algorithm>
 #include <cstring>
+#include <unordered_map>
+#include <util/thread_pool.h>
 #include <util/vector_utils.h>
 
 namespace ngs {
@@ -117,6 +119,62 @@ bool VoiceScheduler::off(const MemState &mem, Voice *voice) {
     return true;
 }
 
+// Dependency level of each voice of the queue, a voice only receives data from voices of a lower level.
+// The queue is already sorted so that sources come before their destinations, which makes a single pass enough.
+static std::vector<uint32_t> compute_voice_levels(const MemState &mem, const std::vector<Voice *> &voice_queue) {
+    std::unordered_map<const Voice *, uint32_t> positions;
+    positions.reserve(voice_queue.size());
+    for (uint32_t i = 0; i < voice_queue.size(); i++)
+        positions.emplace(voice_queue[i], i);
+
+    std::vector<uint32_t> levels(voice_queue.size(), 0);
+    for (uint32_t i = 0; i < voice_queue.size(); i++) {
+        for (const auto &patches : voice_queue[i]->patches) {
+            for (const auto &patch : patches) {
+                if (!patch || patch.get(mem)->output_sub_index == -1)
+                    continue;
+
+                const auto dest = positions.find(patch.get(mem)->dest);
+                // a patch going back in the queue does not order the voices, the queue order did not respect it either
+                if (dest == positions.end() || dest->second <= i)
+                    continue;
+
+                levels[dest->second] = std::max(levels[dest->second], levels[i] + 1);
+            }
+        }
+    }
+
+    return levels;
+}
+
+static bool can_process_concurrently(const Voice *voice) {
+    return std::all_of(voice->rack->modules.begin(), voice->rack->modules.end(), [](const std::unique_ptr<Module> &module) {
+        return !module || module->can_process_concurrently();
+    });
+}
+
+struct VoiceUpdate {
+    bool processed = false;
+    bool finished = false;
+    uint32_t finished_module = 0;
+};
+
+static void process_voice_modules(KernelState &kern, const MemState &mem, const SceUID thread_id, Voice *voice, VoiceUpdate &update,
+    std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
+    memset(voice->products, 0, sizeof(voice->products));
+
+    for (size_t i = 0; i < voice->rack->modules.size(); i++) {
+        if (voice->rack->modules[i]) {
+            if (voice->rack->modules[i]->process(kern, mem, thread_id, voice->datas[i], scheduler_lock, voice_lock)) {
+                update.finished = true;
+                update.finished_module = voice->rack->modules[i]->module_id();
+            }
+        }
+    }
+
+    update.processed = true;
+}
+
 void VoiceScheduler::update(KernelState &kern, const MemState &mem, const SceUID thread_id) {
     std::unique_lock<std::recursive_mutex> scheduler_lock(mutex);
     is_updating = true;
@@ -129,43 +187,71 @@ void VoiceScheduler::update(KernelState &kern, const MemState &mem, const SceUID
         voice->inputs.reset_inputs();
     }
 
-    for (ngs::Voice *voice : queue_copy) {
-        // Modify the state, in peace....
-        std::unique_lock<std::mutex> voice_lock(*voice->voice_mutex);
-        memset(voice->products, 0, sizeof(voice->products));
-
-        bool finished = false;
-        uint32_t finished_module = 0;
-
-        for (size_t i = 0; i < voice->rack->modules.size(); i++) {
-            if (voice->rack->modules[i]) {
-                if (voice->rack->modules[i]->process(kern, mem, thread_id, voice->datas[i], scheduler_lock, voice_lock)) {
-                    finished = true;
-                    finished_module = voice->rack->modules[i]->module_id();
-                }
-            }
-        }
-        if (finished) {
-            voice->is_keyed_off = true;
-            voice->transition(mem, VOICE_STATE_FINALIZING);
-            if (voice->finished_callback) {
-                voice_lock.unlock();
-                scheduler_lock.unlock();
-                voice->invoke_callback(kern, mem, thread_id, voice->finished_callback, voice->finished_callback_user_data, finished_module);
-                scheduler_lock.lock();
-                voice_lock.lock();
-            }
-            voice->is_keyed_off = false;
+    const std::vector<uint32_t> levels = compute_voice_levels(mem, queue_copy);
+    const uint32_t level_count = levels.empty() ? 0 : *std::max_element(levels.begin(), levels.end()) + 1;
+
+    std::vector<VoiceUpdate> updates(queue_copy.size());
+    std::vector<uint32_t> level_voices;
+    std::vector<uint32_t> concurrent_voices;
+
+    for (uint32_t level = 0; level < level_count; level++) {
+        level_voices.clear();
+        concurrent_voices.clear();
+        for (uint32_t i = 0; i < queue_copy.size(); i++) {
+            if (levels[i] != level)
+                continue;
 
-            stop(mem, voice);
+            level_voices.push_back(i);
+            if (can_process_concurrently(queue_copy[i]))
+                concurrent_voices.push_back(i);
         }
 
-        for (size_t i = 0; i < voice->rack->vdef->output_count; i++) {
-            if (voice->products[i].data)
-                deliver_data(mem, queue_copy, voice, static_cast<uint8_t>(i), voice->products[i]);
+        // The voices of a level do not depend on each other, the ones which never call back into the guest are processed
+        // on the worker pool. Their modules never release the scheduler lock, which stays held by this thread meanwhile.
+        if (concurrent_voices.size() > 1) {
+            util::get_worker_pool().parallel_for(static_cast<uint32_t>(concurrent_voices.size()), [&](uint32_t job) {
+                const uint32_t index = concurrent_voices[job];
+                Voice *voice = queue_copy[index];
+                std::unique_lock<std::mutex> voice_lock(*voice->voice_mutex);
+                std::unique_lock<std::recursive_mutex> no_scheduler_lock;
+
+                process_voice_modules(kern, mem, thread_id, voice, updates[index], no_scheduler_lock, voice_lock);
+            });
         }
 
-        voice->frame_count++;
+        // The other voices, the completion and the delivery to the next levels are done in queue order,
+        // so the mix does not depend on the timing of the workers
+        for (const uint32_t index : level_voices) {
+            ngs::Voice *voice = queue_copy[index];
+            VoiceUpdate &update = updates[index];
+            // Modify the state, in peace....
+            std::unique_lock<std::mutex> voice_lock(*voice->voice_mutex);
+
+            if (!update.processed)
+                process_voice_modules(kern, mem, thread_id, voice, update, scheduler_lock, voice_lock);
+
+            if (update.finished) {
+                voice->is_keyed_off = true;
+                voice->transition(mem, VOICE_STATE_FINALIZING);
+                if (voice->finished_callback) {
+                    voice_lock.unlock();
+                    scheduler_lock.unlock();
+                    voice->invoke_callback(kern, mem, thread_id, voice->finished_callback, voice->finished_callback_user_data, update.finished_module);
+                    scheduler_lock.lock();
+                    voice_lock.lock();
+                }
+                voice->is_keyed_off = false;
+
+                stop(mem, voice);
+            }
+
+            for (size_t i = 0; i < voice->rack->vdef->output_count; i++) {
+                if (voice->products[i].data)
+                    deliver_data(mem, queue_copy, voice, static_cast<uint8_t>(i), voice->products[i]);
+            }
+
+            voice->frame_count++;
+        }
     }
 
     while (!operations_pending.empty()) {
@@ -26,6 +26,7 @@
 #include <openssl/evp.h>
 #include <rif2zrif.h>
 
+#include <io/filesystem.h>
 #include <io/functions.h>
 
 #include <config/state.h>
@@ -38,6 +39,12 @@
 
 #include <util/bytes.h>
 #include <util/log.h>
+#include <util/thread_pool.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
 
 // Credits to mmozeiko https://github.com/mmozeiko/pkg2zip
 
@@ -234,23 +241,36 @@ bool install_pkg(const fs::path &pkg_path, EmuEnvState &emuenv, std::string &p_z
         EVP_DecryptFinal_ex(cipher_ctx, data + dec_len, &dec_len);
     };
 
+    // A chunk of file data, decrypted and written by a worker independently of the others
+    struct PkgChunk {
+        fs::path file_path;
+        uint64_t data_offset;
+        uint64_t file_offset;
+        uint64_t size;
+    };
+    constexpr uint64_t PKG_CHUNK_SIZE = 1024 * 1024;
+
+    const uint64_t pkg_size = fs::file_size(pkg_path);
+    const uint64_t pkg_data_offset = byte_swap(pkg_header.data_offset);
+    const auto file_count = (float)byte_swap(pkg_header.file_count);
+    std::vector<PkgChunk> chunks;
+    uint64_t total_size = 0;
     for (uint32_t i = 0; i < byte_swap(pkg_header.file_count); i++) {
         PkgEntry entry;
         uint64_t file_offset = items_offset + i * 32;
-        infile.seekg(byte_swap(pkg_header.data_offset) + file_offset, std::ios_base::beg);
+        infile.seekg(pkg_data_offset + file_offset, std::ios_base::beg);
         infile.read(reinterpret_cast<char *>(&entry), sizeof(PkgEntry));
 
         decrypt_aes_ctr(file_offset / 16, reinterpret_cast<unsigned char *>(&entry), sizeof(PkgEntry));
 
-        if (fs::file_size(pkg_path) < byte_swap(pkg_header.data_offset) + byte_swap(entry.name_offset) + byte_swap(entry.name_size) || fs::file_size(pkg_path) < byte_swap(pkg_header.data_offset) + byte_swap(entry.data_offset) + byte_swap(entry.data_size)) {
+        if (pkg_size < pkg_data_offset + byte_swap(entry.name_offset) + byte_swap(entry.name_size) || pkg_size < pkg_data_offset + byte_swap(entry.data_offset) + byte_swap(entry.data_size)) {
             LOG_ERROR("The pkg file size is too small, possibly corrupted");
             evp_cleanup();
             return false;
         }
-        const auto file_count = (float)byte_swap(pkg_header.file_count);
-        progress_callback(i / file_count * 100.f * 0.6f);
+        progress_callback(i / file_count * 100.f * 0.05f);
         std::vector<unsigned char> name(byte_swap(entry.name_size));
-        infile.seekg(byte_swap(pkg_header.data_offset) + byte_swap(entry.name_offset));
+        infile.seekg(pkg_data_offset + byte_swap(entry.name_offset));
         infile.read((char *)&name[0], byte_swap(entry.name_size));
 
         decrypt_aes_ctr(byte_swap(entry.name_offset) / 16, name.data(), byte_swap(entry.name_size));
@@ -261,36 +281,79 @@ bool install_pkg(const fs::path &pkg_path, EmuEnvState &emuenv, std::string &p_z
         if ((byte_swap(entry.type) & 0xFF) == 4 || (byte_swap(entry.type) & 0xFF) == 18) { // Directory
             fs::create_directories(path / string_name);
         } else { // File
-            fs::ofstream outfile(path / string_name, std::ios::binary);
-
-            auto offset = byte_swap(entry.data_offset);
-            auto data_size = byte_swap(entry.data_size);
-
-            uint8_t counter[0x10];
-            ctr_init(counter, pkg_header.pkg_data_iv, offset / 16);
-            EVP_DecryptInit_ex(cipher_ctx, cipher_CTR, nullptr, main_key, counter);
-            EVP_CIPHER_CTX_set_padding(cipher_ctx, 0);
-
-            std::vector<uint8_t> buffer(0x10000);
-            while (data_size != 0) {
-                int size = data_size < buffer.size() ? data_size : buffer.size();
-                infile.seekg(byte_swap(pkg_header.data_offset) + offset);
-                infile.read(reinterpret_cast<char *>(buffer.data()), size);
+            // Create the file with its final size, the chunks are then written in place in any order
+            const fs::path file_path = path / string_name;
+            fs::ofstream outfile(file_path, std::ios::binary);
+            outfile.close();
+            const uint64_t data_size = byte_swap(entry.data_size);
+            fs::resize_file(file_path, data_size);
 
-                EVP_DecryptUpdate(cipher_ctx, buffer.data(), &dec_len, buffer.data(), size);
+            for (uint64_t offset = 0; offset < data_size; offset += PKG_CHUNK_SIZE)
+                chunks.push_back({ file_path, byte_swap(entry.data_offset) + offset, offset, std::min(PKG_CHUNK_SIZE, data_size - offset) });
+            total_size += data_size;
+        }
+    }
 
-                outfile.write(reinterpret_cast<char *>(buffer.data()), dec_len);
-                offset += size;
-                data_size -= size;
-            }
+    // The pkg is mapped when possible so the workers decrypt straight from it instead of sharing the stream
+    const MappedFilePtr pkg_map = map_file(pkg_path);
+    std::mutex infile_mutex;
+    std::atomic<uint64_t> extracted_size = 0;
+
+    // AES-CTR has no chaining, so a chunk only needs the counter of its first block to be decrypted on its own
+    const auto extract_chunk = [&](const PkgChunk &chunk) {
+        std::vector<uint8_t> buffer(chunk.size);
+        const uint8_t *src = buffer.data();
+        if (pkg_map) {
+            src = pkg_map->data + pkg_data_offset + chunk.data_offset;
+        } else {
+            const std::lock_guard<std::mutex> lock(infile_mutex);
+            infile.seekg(pkg_data_offset + chunk.data_offset);
+            infile.read(reinterpret_cast<char *>(buffer.data()), chunk.size);
+        }
 
-            EVP_DecryptFinal_ex(cipher_ctx, buffer.data(), &dec_len);
-            outfile.write(reinterpret_cast<char *>(buffer.data()), dec_len);
-            outfile.close();
+        uint8_t counter[0x10];
+        ctr_init(counter, pkg_header.pkg_data_iv, chunk.data_offset / 16);
+        EVP_CIPHER_CTX *chunk_ctx = EVP_CIPHER_CTX_new();
+        EVP_DecryptInit_ex(chunk_ctx, cipher_CTR, nullptr, main_key, counter);
+        EVP_CIPHER_CTX_set_padding(chunk_ctx, 0);
+        int len = 0;
+        EVP_DecryptUpdate(chunk_ctx, buffer.data(), &len, src, static_cast<int>(chunk.size));
+        EVP_DecryptFinal_ex(chunk_ctx, buffer.data() + len, &len);
+        EVP_CIPHER_CTX_free(chunk_ctx);
+
+        fs::fstream outfile(chunk.file_path, std::ios::in | std::ios::out | std::ios::binary);
+        outfile.seekp(chunk.file_offset);
+        outfile.write(reinterpret_cast<const char *>(buffer.data()), chunk.size);
+        extracted_size += chunk.size;
+        if (!outfile) {
+            LOG_ERROR("Failed to write {}", chunk.file_path);
+            return false;
         }
+        return true;
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<bool>> results;
+    results.reserve(chunks.size());
+    for (const PkgChunk &chunk : chunks)
+        results.push_back(util::get_worker_pool().submit([&extract_chunk, &chunk]() { return extract_chunk(chunk); }));
+
+    bool extracted = true;
+    for (auto &result : results) {
+        while (result.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+            progress_callback(5.f + (total_size ? (float)extracted_size / total_size : 1.f) * 100.f * 0.55f);
+        extracted &= result.get();
     }
     infile.close();
 
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO("Extracted {} MiB in {:.2f}s ({:.1f} MiB/s)", total_size / (1024 * 1024), seconds, seconds > 0 ? total_size / (1024.0 * 1024.0) / seconds : 0.0);
+    if (!extracted) {
+        evp_cleanup();
+        return false;
+    }
+    progress_callback(60);
+
     evp_cleanup();
     fs::path title_id_src = path;
     fs::path title_id_dst = fs_utils::path_concat(path, "_dec");
@@ -321,6 +384,7 @@ bool install_pkg(const fs::path &pkg_path, EmuEnvState &emuenv, std::string &p_z
         } else {
             fs::remove_all(title_id_src);
             fs::rename(title_id_dst, title_id_src);
+            build_path_index(emuenv.io, emuenv.pref_path, emuenv.app_info.app_title_id, emuenv.app_info.app_category);
             return true;
         }
         break;
@@ -337,6 +401,7 @@ bool install_pkg(const fs::path &pkg_path, EmuEnvState &emuenv, std::string &p_z
 
     if (!copy_path(title_id_src, emuenv.pref_path, emuenv.app_info.app_title_id, emuenv.app_info.app_category))
         return false;
+    build_path_index(emuenv.io, emuenv.pref_path, emuenv.app_info.app_title_id, emuenv.app_info.app_category);
 
     create_license(emuenv, zRIF);
 
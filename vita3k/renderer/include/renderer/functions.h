@@ -92,8 +92,20 @@ void destroy_context(State &state, std::unique_ptr<Context> &context);
 bool create_render_target(State &state, std::unique_ptr<RenderTarget> &rt, const SceGxmRenderTargetParams *params);
 void destroy_render_target(State &state, std::unique_ptr<RenderTarget> &rt);
 
+struct CommandAllocatorStats {
+    size_t slab_count;
+    // number of commands allocated from the system
+    size_t capacity;
+    // total number of commands handed out
+    uint64_t allocation_count;
+    // number of commands freed and put back in the pool
+    uint64_t recycled_count;
+};
+
+// pooled allocation, commands can be freed from any thread
 Command *generic_command_allocate();
 void generic_command_free(Command *cmd);
+CommandAllocatorStats get_command_allocator_stats();
 
 template <typename... Args>
 bool add_command(Context *ctx, const CommandOpcode opcode, int *status, Args... arguments) {
@@ -24,6 +24,7 @@
 #include <renderer/gl/state.h>
 #include <renderer/gl/types.h>
 
+#include <functional>
 #include <memory>
 
 struct MemState;
@@ -33,7 +34,7 @@ namespace renderer::gl {
 
 // Compile program.
 SharedGLObject compile_program(GLState &renderer, GLContext &context, const GxmRecordState &state, const FeatureState &features, const MemState &mem, bool shader_cache, bool spirv, bool maskupdate);
-void pre_compile_program(GLState &renderer, const ShadersHash &hashs);
+void pre_compile_programs(GLState &renderer, const std::function<void()> &draw_progress);
 
 // Uniforms.
 bool set_uniform_buffer(GLContext &context, const ShaderProgram *program, const bool vertex_shader, const int block_num, const int size, const uint8_t *data);
@@ -62,7 +62,7 @@ struct GLState : public renderer::State {
 
     std::string_view get_gpu_name() override;
 
-    void precompile_shader(const ShadersHash &hash) override;
+    void precompile_shaders(const std::function<void()> &draw_progress) override;
     void preclose_action() override;
 };
 
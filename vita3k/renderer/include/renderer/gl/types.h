@@ -46,8 +46,8 @@ inline bool operator==(const ExcludedUniform &lhs, const ExcludedUniform &rhs) {
     return (lhs.name == rhs.name) && (lhs.program == rhs.program);
 }
 
-typedef std::map<Sha256Hash, SharedGLObject> ShaderCache;
-typedef std::tuple<Sha256Hash, Sha256Hash> ProgramHashes;
+typedef std::map<Xxh128Hash, SharedGLObject> ShaderCache;
+typedef std::tuple<Xxh128Hash, Xxh128Hash> ProgramHashes;
 typedef std::map<ProgramHashes, SharedGLObject> ProgramCache;
 typedef std::vector<ExcludedUniform> ExcludedUniforms; // vector instead of unordered_set since it's much faster for few elements
 typedef std::map<GLuint, GLenum> UniformTypes;
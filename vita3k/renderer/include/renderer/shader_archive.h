@@ -0,0 +1,84 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#pragma once
+
+#include <util/containers.h>
+#include <util/fs.h>
+#include <util/hash.h>
+#include <util/mapped_file.h>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace renderer {
+
+enum struct ShaderFormat : uint8_t {
+    GLSL,
+    SPIRV,
+    COUNT
+};
+
+/**
+ * \brief Translated shaders of an app, stored in a single append-only file.
+ *
+ * Each record is the hash of the gxp program followed by the shader compressed with zlib. Opening the archive maps
+ * the file and only reads the record headers to build the index, a shader is inflated from the mapping when it is
+ * loaded. New shaders are appended to the file, a record is never rewritten.
+ */
+class ShaderArchive {
+public:
+    ShaderArchive() = default;
+    ShaderArchive(const ShaderArchive &) = delete;
+    ShaderArchive &operator=(const ShaderArchive &) = delete;
+
+    // Open the archive or create it if it does not exist or was written for another shader version
+    bool open(const fs::path &archive_path, uint32_t shader_version);
+    void close();
+
+    bool contains(ShaderFormat format, const Xxh128Hash &hash);
+    // Return an empty shader if the archive does not contain it
+    std::string load_glsl(const Xxh128Hash &hash);
+    std::vector<uint32_t> load_spirv(const Xxh128Hash &hash);
+    // Can be called from any thread, once saved the shader can be loaded right away, a shader already saved is ignored
+    void save(ShaderFormat format, const Xxh128Hash &hash, const void *data, uint32_t size);
+
+private:
+    struct Entry {
+        uint64_t offset;
+        uint32_t stored_size;
+        uint32_t size;
+        bool compressed;
+    };
+
+    template <typename R>
+    R load(ShaderFormat format, const Xxh128Hash &hash);
+
+    std::mutex mutex;
+    fs::path path;
+    // can be behind the file if shaders were appended since it was mapped
+    MappedFilePtr mapping;
+    fs::ofstream file;
+    uint64_t file_size = 0;
+    std::array<unordered_map_fast<Xxh128Hash, Entry>, static_cast<size_t>(ShaderFormat::COUNT)> entries;
+};
+
+} // namespace renderer
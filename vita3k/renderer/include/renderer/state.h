@@ -19,10 +19,13 @@
 
 #include <features/state.h>
 #include <renderer/commands.h>
+#include <renderer/shader_archive.h>
 #include <renderer/types.h>
 #include <threads/queue.h>
 
+#include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <string_view>
 
@@ -71,12 +74,13 @@ struct State {
 
     std::vector<ShadersHash> shaders_cache_hashs;
     std::string shader_version;
+    ShaderArchive shader_archive;
 
     int last_scene_id = 0;
 
     // on Vulkan, this is actually the number of pipelines compiled
     uint32_t shaders_count_compiled = 0;
-    uint32_t programs_count_pre_compiled = 0;
+    std::atomic<uint32_t> programs_count_pre_compiled = 0;
 
     bool should_display;
 
@@ -126,7 +130,9 @@ struct State {
 
     virtual std::string_view get_gpu_name() = 0;
 
-    virtual void precompile_shader(const ShadersHash &hash) = 0;
+    // Compile the programs of shaders_cache_hashs using the worker pool and return once they are done,
+    // draw_progress is called from this thread meanwhile to report programs_count_pre_compiled
+    virtual void precompile_shaders(const std::function<void()> &draw_progress) = 0;
     virtual void preclose_action() = 0;
 
     virtual ~State() = default;
@@ -18,13 +18,17 @@
 #pragma once
 
 #include <gxm/types.h>
+#include <mem/util.h>
 #include <util/containers.h>
 #include <util/fs.h>
 
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 namespace ddspp {
 struct Descriptor;
@@ -37,8 +41,30 @@ enum SceGxmTextureBaseFormat : uint32_t;
 namespace renderer {
 enum class Backend : uint32_t;
 static constexpr size_t TextureCacheSize = 1024;
+// maximum size in bytes of the textures kept by the decoded texture cache
+static constexpr size_t DecodedTextureCacheSize = 64 * 1024 * 1024;
 
 typedef std::array<uint32_t, 4> TextureGxmDataRepr;
+
+// Hash of each page fully covered by a texture, the pages are write-protected and flagged
+// as dirty when written to so only these need to be hashed again
+struct TexturePageTracker {
+    // address of the first page
+    Address start = 0;
+    std::vector<uint64_t> page_hashes;
+    // set by the access violation handler, can be accessed from any thread
+    std::unique_ptr<std::atomic<bool>[]> dirty;
+};
+
+struct TextureHashStats {
+    // number of bytes read to compute the texture hashes
+    uint64_t bytes_hashed = 0;
+    // pages whose hash was computed again because they were written to
+    uint64_t dirty_pages = 0;
+    // pages whose previous hash was reused
+    uint64_t clean_pages = 0;
+};
+
 struct TextureCacheInfo {
     uint64_t hash = 0;
     SceGxmTexture texture;
@@ -46,6 +72,8 @@ struct TextureCacheInfo {
     uint32_t texture_size = 0;
     bool use_hash = false;
     bool dirty = false;
+    // set when the hash is computed incrementally
+    std::shared_ptr<TexturePageTracker> page_tracker;
     // used for texture importation
     bool is_imported = false;
     bool is_srgb = false;
@@ -66,6 +94,27 @@ struct AvailableTexture {
     std::shared_ptr<fs::path> folder_path;
 };
 
+// Result of the textures decompressed on the CPU, so that uploading an unchanged texture again
+// (for example after it was evicted from the texture cache) skips the decompression
+class DecodedTextureCache {
+public:
+    typedef std::shared_ptr<const std::vector<uint8_t>> Data;
+
+    Data get(uint64_t key);
+    void insert(uint64_t key, Data data);
+
+private:
+    struct Entry {
+        uint64_t key;
+        Data data;
+    };
+
+    // most recently used first
+    std::list<Entry> entries;
+    unordered_map_fast<uint64_t, std::list<Entry>::iterator> lookup;
+    size_t total_size = 0;
+};
+
 class TextureCache {
 protected:
     // current texture info the cache is looking at
@@ -76,6 +125,16 @@ protected:
     // are we in the process of importing a texture
     bool importing_texture = false;
 
+    DecodedTextureCache decoded_textures;
+
+    // hashing statistics of the current frame
+    std::atomic<uint64_t> frame_bytes_hashed = 0;
+    std::atomic<uint64_t> frame_dirty_pages = 0;
+    std::atomic<uint64_t> frame_clean_pages = 0;
+    // sum of the statistics since they were last logged
+    TextureHashStats logged_hash_stats;
+    uint32_t logged_frames = 0;
+
     // dds/png raw file
     std::vector<uint8_t> imported_texture_raw_data;
     // pointer to the decoded content
@@ -97,6 +156,8 @@ protected:
 public:
     Backend backend;
     bool use_protect = false;
+    // only hash the pages of a texture which were written to since the last check
+    bool use_incremental_hash = false;
     // use a separate sampler cache
     bool use_sampler_cache = false;
     int anisotropic_filtering = 1;
@@ -130,6 +191,15 @@ public:
 
     virtual void configure_sampler(size_t index, const SceGxmTexture &texture) {}
 
+    // write-protect the pages of the texture and compute its hash
+    void track_texture_pages(TextureCacheInfo &info, const SceGxmTexture &gxm_texture, MemState &mem);
+    // only hash again the pages which were written to
+    uint64_t hash_texture_pages(TextureCacheInfo &info, const SceGxmTexture &gxm_texture, MemState &mem);
+    uint64_t hash_texture(TextureCacheInfo &info, const SceGxmTexture &gxm_texture, MemState &mem);
+
+    // must be called once per frame, log the hashing statistics at a regular interval
+    TextureHashStats end_frame();
+
     void upload_texture(const SceGxmTexture &gxm_texture, MemState &mem);
     void cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemState &mem);
 
@@ -39,7 +39,7 @@ using UniformBufferSizes = std::array<std::uint32_t, 15>;
 namespace renderer {
 
 // State types
-typedef std::map<Sha256Hash, const SceGxmProgram *> GXPPtrMap;
+typedef std::map<Xxh128Hash, const SceGxmProgram *> GXPPtrMap;
 
 struct UniformSetRequest {
     const SceGxmProgramParameter *parameter;
@@ -97,8 +97,8 @@ struct GxmStencilStateValues {
 
 // we hash the first part of this state as a key for the pipeline cache in vulkan
 struct GxmRecordState {
-    Sha256Hash vertex_program_hash;
-    Sha256Hash fragment_program_hash;
+    Xxh128Hash vertex_program_hash;
+    Xxh128Hash fragment_program_hash;
 
     SceGxmColorBaseFormat color_base_format;
 
@@ -165,8 +165,8 @@ struct Context {
     int render_finish_status = 0;
     int notification_finish_status = 0;
 
-    Sha256Hash last_draw_fragment_program_hash;
-    Sha256Hash last_draw_vertex_program_hash;
+    Xxh128Hash last_draw_fragment_program_hash;
+    Xxh128Hash last_draw_vertex_program_hash;
 
     std::map<int, std::vector<uint8_t>> ubo_data;
 
@@ -178,7 +178,7 @@ struct Context {
 typedef std::bitset<SCE_GXM_MAX_TEXTURE_UNITS> TextureInfo;
 
 struct ShaderProgram {
-    Sha256Hash hash;
+    Xxh128Hash hash;
     UniformBufferSizes uniform_buffer_sizes; // Size of the buffer in 4-bytes unit
     UniformBufferSizes uniform_buffer_data_offsets; // Offset of the buffer in 4-bytes unit
     size_t max_total_uniform_buffer_storage;
@@ -196,8 +196,8 @@ struct VertexProgram : ShaderProgram {
 };
 
 struct ShadersHash {
-    Sha256Hash frag;
-    Sha256Hash vert;
+    Xxh128Hash frag;
+    Xxh128Hash vert;
 };
 
 struct RenderTarget {
@@ -32,7 +32,7 @@ struct SceGxmVertexProgram;
 enum SceGxmPrimitiveType : uint32_t;
 struct MemState;
 
-using Sha256Hash = std::array<uint8_t, 32>;
+using Xxh128Hash = std::array<uint8_t, 16>;
 
 namespace shader {
 struct Hints;
@@ -77,10 +77,10 @@ private:
     // only used when accessing the shaders map
     std::mutex shaders_mutex;
     // because of multithreading, we want the pointers to remain stable
-    unordered_map_stable<Sha256Hash, vk::ShaderModule> shaders;
+    unordered_map_stable<Xxh128Hash, vk::ShaderModule> shaders;
     unordered_map_stable<uint64_t, vk::Pipeline> pipelines;
 
-    vk::PipelineShaderStageCreateInfo retrieve_shader(const SceGxmProgram *program, const Sha256Hash &hash, bool is_vertex, bool maskupdate, MemState &mem, const shader::Hints &hints, bool is_srgb = false);
+    vk::PipelineShaderStageCreateInfo retrieve_shader(const SceGxmProgram *program, const Xxh128Hash &hash, bool is_vertex, bool maskupdate, MemState &mem, const shader::Hints &hints, bool is_srgb = false);
     vk::PipelineVertexInputStateCreateInfo get_vertex_input_state(const SceGxmVertexProgram &vertex_program, MemState &mem);
 
     // queue containing request sent by the main thread to the compile threads
@@ -119,7 +119,7 @@ public:
     vk::RenderPass retrieve_render_pass(vk::Format format, bool force_load, bool force_store, bool no_color = false);
     vk::Pipeline retrieve_pipeline(VKContext &context, SceGxmPrimitiveType &type, bool consider_for_async, MemState &mem);
 
-    vk::ShaderModule precompile_shader(const Sha256Hash &hash, bool search_first = true);
+    vk::ShaderModule precompile_shader(const Xxh128Hash &hash, bool search_first = true);
 
     void set_async_compilation(bool enable);
 };
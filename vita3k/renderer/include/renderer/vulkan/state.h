@@ -132,7 +132,7 @@ struct VKState : public renderer::State {
     std::vector<std::string> get_gpu_list() override;
     std::string_view get_gpu_name() override;
 
-    void precompile_shader(const ShadersHash &hash) override;
+    void precompile_shaders(const std::function<void()> &draw_progress) override;
     void preclose_action() override;
 
     inline FrameObject &frame() {
@@ -30,14 +30,6 @@
 struct FeatureState;
 
 namespace renderer {
-Command *generic_command_allocate() {
-    return new Command;
-}
-
-void generic_command_free(Command *cmd) {
-    delete cmd;
-}
-
 void complete_command(State &state, CommandHelper &helper, const int code) {
     auto lock = std::unique_lock(state.command_finish_one_mutex);
     helper.complete(code);
@@ -0,0 +1,157 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/commands.h>
+#include <renderer/functions.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace renderer {
+// number of commands allocated at once when no freed command is available
+static constexpr size_t COMMAND_SLAB_SIZE = 512;
+// number of commands a thread frees before giving them back to the other threads
+static constexpr size_t COMMAND_RETIRE_BATCH_SIZE = 64;
+
+/**
+ * Commands are allocated by the guest threads and freed by the renderer thread (or by the guest thread
+ * overwriting a deferred command list). Each thread keeps a local chain of free commands and a chain of
+ * the commands it freed, so the shared lists are only locked once per batch of commands, and the
+ * memory is never given back to the system allocator.
+ */
+class CommandAllocator {
+public:
+    struct ThreadCache {
+        CommandAllocator &allocator;
+        Command *free_first = nullptr;
+
+        Command *retired_first = nullptr;
+        Command *retired_last = nullptr;
+        size_t retired_count = 0;
+
+        explicit ThreadCache(CommandAllocator &allocator)
+            : allocator(allocator) {
+        }
+
+        ~ThreadCache() {
+            // the thread is exiting, give everything back
+            retire();
+            Command *last = free_first;
+            while (last && last->next)
+                last = last->next;
+            allocator.give_back(free_first, last, 0);
+        }
+
+        void retire() {
+            allocator.give_back(retired_first, retired_last, retired_count);
+            retired_first = nullptr;
+            retired_last = nullptr;
+            retired_count = 0;
+        }
+    };
+
+    Command *allocate() {
+        ThreadCache &cache = get_thread_cache();
+        if (!cache.free_first)
+            refill(cache);
+
+        Command *cmd = cache.free_first;
+        cache.free_first = cmd->next;
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        return new (cmd) Command;
+    }
+
+    void free(Command *cmd) {
+        ThreadCache &cache = get_thread_cache();
+        cmd->next = cache.retired_first;
+        cache.retired_first = cmd;
+        if (!cache.retired_last)
+            cache.retired_last = cmd;
+        if (++cache.retired_count >= COMMAND_RETIRE_BATCH_SIZE)
+            cache.retire();
+    }
+
+    CommandAllocatorStats get_stats() {
+        const std::lock_guard<std::mutex> guard(mutex);
+        return {
+            .slab_count = slabs.size(),
+            .capacity = slabs.size() * COMMAND_SLAB_SIZE,
+            .allocation_count = allocations.load(std::memory_order_relaxed),
+            .recycled_count = recycled,
+        };
+    }
+
+private:
+    ThreadCache &get_thread_cache() {
+        thread_local ThreadCache cache(*this);
+        return cache;
+    }
+
+    void give_back(Command *first, Command *last, size_t count) {
+        if (!first)
+            return;
+
+        const std::lock_guard<std::mutex> guard(mutex);
+        last->next = returned;
+        returned = first;
+        recycled += count;
+    }
+
+    void refill(ThreadCache &cache) {
+        const std::lock_guard<std::mutex> guard(mutex);
+        if (returned) {
+            // take all the commands freed by the other threads at once
+            cache.free_first = returned;
+            returned = nullptr;
+            return;
+        }
+
+        auto &slab = slabs.emplace_back(std::make_unique<Command[]>(COMMAND_SLAB_SIZE));
+        for (size_t i = 0; i < COMMAND_SLAB_SIZE - 1; i++)
+            slab[i].next = &slab[i + 1];
+        slab[COMMAND_SLAB_SIZE - 1].next = nullptr;
+        cache.free_first = &slab[0];
+    }
+
+    std::mutex mutex;
+    Command *returned = nullptr;
+    std::vector<std::unique_ptr<Command[]>> slabs;
+    uint64_t recycled = 0;
+    std::atomic<uint64_t> allocations = 0;
+};
+
+static CommandAllocator &get_command_allocator() {
+    // never destroyed, commands may still be freed by threads exiting after the static destructors
+    static CommandAllocator *allocator = new CommandAllocator;
+    return *allocator;
+}
+
+Command *generic_command_allocate() {
+    return get_command_allocator().allocate();
+}
+
+void generic_command_free(Command *cmd) {
+    if (cmd)
+        get_command_allocator().free(cmd);
+}
+
+CommandAllocatorStats get_command_allocator_stats() {
+    return get_command_allocator().get_stats();
+}
+} // namespace renderer
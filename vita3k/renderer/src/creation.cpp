@@ -191,7 +191,7 @@ bool create(std::unique_ptr<FragmentProgram> &fp, State &state, const SceGxmProg
     }
 
     // Try to hash this shader
-    fp->hash = sha256(&program, program.size);
+    fp->hash = xxh128(&program, program.size);
     gxp_ptr_map.emplace(fp->hash, &program);
 
     fp->buffer_count = shader::usse::get_uniform_buffer_sizes(program, fp->uniform_buffer_sizes);
@@ -218,7 +218,7 @@ bool create(std::unique_ptr<VertexProgram> &vp, State &state, const SceGxmProgra
     }
 
     // Hash this shader
-    vp->hash = sha256(&program, program.size);
+    vp->hash = xxh128(&program, program.size);
     gxp_ptr_map.emplace(vp->hash, &program);
 
     vp->buffer_count = shader::usse::get_uniform_buffer_sizes(program, vp->uniform_buffer_sizes);
@@ -274,7 +274,7 @@ bool init(SDL_Window *window, std::unique_ptr<State> &state, Backend backend, co
     state->current_backend = backend;
 
     // Can change this
-    state->command_buffer_queue.maxPendingCount_ = 30;
+    state->command_buffer_queue.set_capacity(30);
 
     return true;
 }
@@ -271,6 +271,7 @@ bool GLState::init() {
 
 void GLState::late_init(const Config &cfg, const std::string_view game_id, MemState &mem) {
     texture_cache.init(cfg.hashless_texture_cache, texture_folder(), game_id);
+    texture_cache.use_incremental_hash = cfg.incremental_texture_hash;
 }
 
 bool create(std::unique_ptr<Context> &context) {
@@ -658,6 +659,8 @@ void GLState::render_frame(const SceFVector2 &viewport_pos, const SceFVector2 &v
     if (!frame.base)
         return;
 
+    texture_cache.end_frame();
+
     // Check if the surface exists
     float uvs[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
     bool need_uv = true;
@@ -758,8 +761,8 @@ std::string_view GLState::get_gpu_name() {
     return reinterpret_cast<const GLchar *>(glGetString(GL_RENDERER));
 }
 
-void GLState::precompile_shader(const ShadersHash &hash) {
-    pre_compile_program(*this, hash);
+void GLState::precompile_shaders(const std::function<void()> &draw_progress) {
+    pre_compile_programs(*this, draw_progress);
 }
 
 void GLState::preclose_action() {}
@@ -0,0 +1,217 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <renderer/shader_archive.h>
+
+#include <util/log.h>
+
+#include <miniz.h>
+
+#include <cstring>
+
+namespace renderer {
+
+constexpr char SHADER_ARCHIVE_MAGIC[8] = { 'V', '3', 'K', 'S', 'H', 'A', 'D', 'R' };
+constexpr uint32_t SHADER_ARCHIVE_VERSION = 2;
+
+struct ShaderArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t shader_version;
+};
+
+struct ShaderRecordHeader {
+    Xxh128Hash hash;
+    uint8_t format;
+    uint8_t compressed;
+    uint16_t padding;
+    // size of the shader, and of its data in the file once compressed
+    uint32_t size;
+    uint32_t stored_size;
+};
+
+bool ShaderArchive::open(const fs::path &archive_path, const uint32_t shader_version) {
+    close();
+
+    std::lock_guard<std::mutex> guard(mutex);
+    path = archive_path;
+
+    // index the records, a record cut short by the emulator closing while writing it is dropped with what follows
+    uint64_t valid_size = 0;
+    mapping = map_file(path);
+    ShaderArchiveHeader header;
+    if (mapping && mapping->size >= sizeof(header)) {
+        memcpy(&header, mapping->data, sizeof(header));
+        if (memcmp(header.magic, SHADER_ARCHIVE_MAGIC, sizeof(SHADER_ARCHIVE_MAGIC)) == 0 && header.version == SHADER_ARCHIVE_VERSION
+            && header.shader_version == shader_version)
+            valid_size = sizeof(header);
+    }
+
+    if (valid_size > 0) {
+        ShaderRecordHeader record;
+        while (valid_size + sizeof(record) <= mapping->size) {
+            memcpy(&record, mapping->data + valid_size, sizeof(record));
+            const uint64_t record_end = valid_size + sizeof(record) + record.stored_size;
+            if (record.format >= static_cast<uint8_t>(ShaderFormat::COUNT) || record_end > mapping->size)
+                break;
+
+            entries[record.format][record.hash] = { valid_size + sizeof(record), record.stored_size, record.size, record.compressed != 0 };
+            valid_size = record_end;
+        }
+    }
+
+    boost::system::error_code ec;
+    if (valid_size == 0) {
+        // missing or outdated, start a new archive
+        mapping.reset();
+        for (auto &format_entries : entries)
+            format_entries.clear();
+
+        fs::create_directories(path.parent_path(), ec);
+        fs::ofstream new_file(path, std::ios::binary | std::ios::trunc);
+        memcpy(header.magic, SHADER_ARCHIVE_MAGIC, sizeof(SHADER_ARCHIVE_MAGIC));
+        header.version = SHADER_ARCHIVE_VERSION;
+        header.shader_version = shader_version;
+        new_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (!new_file) {
+            LOG_ERROR("Failed to create shader archive {}", path);
+            return false;
+        }
+        valid_size = sizeof(header);
+    } else if (valid_size < mapping->size) {
+        LOG_WARN("Dropping {} bytes at the end of shader archive {}", mapping->size - valid_size, path);
+        // the file can't be resized while it is mapped on Windows, it will be mapped again when needed
+        mapping.reset();
+        fs::resize_file(path, valid_size, ec);
+        if (ec) {
+            LOG_ERROR("Failed to resize shader archive {}: {}", path, ec.message());
+            return false;
+        }
+    }
+
+    file.open(path, std::ios::binary | std::ios::app);
+    file_size = valid_size;
+
+    return file.is_open();
+}
+
+void ShaderArchive::close() {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (file.is_open())
+        file.close();
+    mapping.reset();
+    file_size = 0;
+    for (auto &format_entries : entries)
+        format_entries.clear();
+}
+
+bool ShaderArchive::contains(const ShaderFormat format, const Xxh128Hash &hash) {
+    std::lock_guard<std::mutex> guard(mutex);
+    const auto &format_entries = entries[static_cast<size_t>(format)];
+    return format_entries.find(hash) != format_entries.end();
+}
+
+template <typename R>
+R ShaderArchive::load(const ShaderFormat format, const Xxh128Hash &hash) {
+    Entry entry;
+    MappedFilePtr view;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        const auto &format_entries = entries[static_cast<size_t>(format)];
+        const auto it = format_entries.find(hash);
+        if (it == format_entries.end())
+            return {};
+
+        entry = it->second;
+        if (!mapping || entry.offset + entry.stored_size > mapping->size) {
+            // the shader was appended after the file was mapped
+            file.flush();
+            mapping = map_file(path);
+            if (!mapping || entry.offset + entry.stored_size > mapping->size) {
+                LOG_ERROR("Failed to map shader archive {}", path);
+                return {};
+            }
+        }
+        // keep the mapping alive while inflating the shader without holding the lock
+        view = mapping;
+    }
+
+    R source;
+    source.resize((entry.size + sizeof(typename R::value_type) - 1) / sizeof(typename R::value_type));
+    uint8_t *dest = reinterpret_cast<uint8_t *>(source.data());
+    const uint8_t *stored = view->data + entry.offset;
+    if (entry.compressed) {
+        mz_ulong dest_size = entry.size;
+        const int res = mz_uncompress(dest, &dest_size, stored, entry.stored_size);
+        if (res != MZ_OK || dest_size != entry.size) {
+            LOG_ERROR("Failed to decompress shader {} from archive {}: {}", hex_string(hash), path, mz_error(res));
+            return {};
+        }
+    } else {
+        memcpy(dest, stored, entry.size);
+    }
+
+    return source;
+}
+
+std::string ShaderArchive::load_glsl(const Xxh128Hash &hash) {
+    return load<std::string>(ShaderFormat::GLSL, hash);
+}
+
+std::vector<uint32_t> ShaderArchive::load_spirv(const Xxh128Hash &hash) {
+    return load<std::vector<uint32_t>>(ShaderFormat::SPIRV, hash);
+}
+
+void ShaderArchive::save(const ShaderFormat format, const Xxh128Hash &hash, const void *data, const uint32_t size) {
+    // the shaders are translated again when the cache is not used, they must not be appended every time
+    if (contains(format, hash))
+        return;
+
+    // compress before taking the lock, shaders can be translated by several threads at once
+    std::vector<uint8_t> compressed(mz_compressBound(size));
+    mz_ulong compressed_size = compressed.size();
+    const bool is_compressed = mz_compress(compressed.data(), &compressed_size, static_cast<const uint8_t *>(data), size) == MZ_OK
+        && compressed_size < size;
+
+    ShaderRecordHeader record{};
+    record.hash = hash;
+    record.format = static_cast<uint8_t>(format);
+    record.compressed = is_compressed;
+    record.size = size;
+    record.stored_size = is_compressed ? static_cast<uint32_t>(compressed_size) : size;
+
+    std::lock_guard<std::mutex> guard(mutex);
+    // another thread may have saved the same shader meanwhile
+    auto &format_entries = entries[record.format];
+    if (!file.is_open() || format_entries.find(hash) != format_entries.end())
+        return;
+
+    file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    file.write(is_compressed ? reinterpret_cast<const char *>(compressed.data()) : static_cast<const char *>(data), record.stored_size);
+    file.flush();
+    if (!file) {
+        LOG_ERROR("Failed to write shader {} to archive {}", hex_string(hash), path);
+        file.close();
+        return;
+    }
+
+    format_entries[hash] = { file_size + sizeof(record), record.stored_size, size, is_compressed };
+    file_size += sizeof(record) + record.stored_size;
+}
+
+} // namespace renderer
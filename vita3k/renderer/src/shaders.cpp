@@ -20,21 +20,28 @@
 #include <renderer/vulkan/state.h>
 
 #include <gxm/types.h>
+#include <renderer/shader_archive.h>
 #include <renderer/state.h>
 #include <renderer/types.h>
 #include <shader/spirv_recompiler.h>
 #include <util/fs.h>
 #include <util/log.h>
 
+#include <array>
+#include <charconv>
+#include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace renderer {
 
-bool get_shaders_cache_hashs(State &renderer) {
-    const std::string hash_file_name = fmt::format("hashs-{}.dat", (renderer.current_backend == Backend::OpenGL) ? "gl" : "vk");
+static std::string get_hashs_file_name(const State &renderer) {
+    return fmt::format("hashs-{}-xxh3.dat", (renderer.current_backend == Backend::OpenGL) ? "gl" : "vk");
+}
 
-    fs::ifstream shaders_hashs(renderer.shaders_path / hash_file_name, std::ios::in | std::ios::binary);
+static bool read_shaders_cache_hashs(State &renderer) {
+    fs::ifstream shaders_hashs(renderer.shaders_path / get_hashs_file_name(renderer), std::ios::in | std::ios::binary);
     if (!shaders_hashs.is_open())
         return false;
 
@@ -67,9 +74,9 @@ bool get_shaders_cache_hashs(State &renderer) {
     // Read Hashs info value
     for (size_t a = 0; a < size; a++) {
         auto read = [&shaders_hashs]() {
-            Sha256Hash hash;
+            Xxh128Hash hash;
 
-            shaders_hashs.read(reinterpret_cast<char *>(hash.data()), sizeof(Sha256Hash));
+            shaders_hashs.read(reinterpret_cast<char *>(hash.data()), sizeof(Xxh128Hash));
 
             return hash;
         };
@@ -88,8 +95,7 @@ bool get_shaders_cache_hashs(State &renderer) {
 
 void save_shaders_cache_hashs(State &renderer, std::vector<ShadersHash> &shaders_cache_hashs) {
     fs::create_directories(renderer.shaders_path);
-    std::string hash_file_name = fmt::format("hashs-{}.dat", (renderer.current_backend == Backend::OpenGL) ? "gl" : "vk");
-    fs::ofstream shaders_hashs(renderer.shaders_path / hash_file_name, std::ios::out | std::ios::binary);
+    fs::ofstream shaders_hashs(renderer.shaders_path / get_hashs_file_name(renderer), std::ios::out | std::ios::binary);
 
     if (shaders_hashs.is_open()) {
         // Write Size of shaders cache hashes list
@@ -104,8 +110,8 @@ void save_shaders_cache_hashs(State &renderer, std::vector<ShadersHash> &shaders
 
         // Write shader hash list
         for (const auto &hash : shaders_cache_hashs) {
-            auto write = [&shaders_hashs](const Sha256Hash &hash) {
-                shaders_hashs.write(reinterpret_cast<const char *>(hash.data()), sizeof(Sha256Hash));
+            auto write = [&shaders_hashs](const Xxh128Hash &hash) {
+                shaders_hashs.write(reinterpret_cast<const char *>(hash.data()), sizeof(Xxh128Hash));
             };
 
             write(hash.frag);
@@ -115,90 +121,195 @@ void save_shaders_cache_hashs(State &renderer, std::vector<ShadersHash> &shaders
     }
 }
 
-static bool load_shader(const fs::path &shader_name, char **destination, std::size_t &size_read) {
-    fs::ifstream is(shader_name, fs::ifstream::binary);
-    if (!is) {
+template <size_t N>
+static bool parse_hash(const std::string_view text, std::array<uint8_t, N> &hash) {
+    if (text.size() != N * 2)
         return false;
+
+    for (size_t i = 0; i < N; i++) {
+        const auto res = std::from_chars(text.data() + i * 2, text.data() + i * 2 + 2, hash[i], 16);
+        if (res.ec != std::errc() || res.ptr != text.data() + i * 2 + 2)
+            return false;
     }
 
-    is.seekg(0, fs::ifstream::end);
-    size_read = is.tellg();
-    is.seekg(0);
+    return true;
+}
 
-    if (size_read == 0) {
-        return false;
+/**
+ * \brief Import the shader cache of the versions identifying the programs by their sha256.
+ *
+ * The list of programs was saved as hashs-<backend>.dat and every shader had its own file named after the sha256 of
+ * its program. The gxp dumps of the shader log are named after the sha256 too, so hashing them gives the new
+ * identifier of the program. The shaders whose gxp dump was deleted are dropped and will be translated again.
+ */
+static void import_sha256_shader_cache(State &renderer) {
+    const bool is_vulkan = renderer.current_backend == Backend::Vulkan;
+    const fs::path hashs_path = renderer.shaders_path / fmt::format("hashs-{}.dat", is_vulkan ? "vk" : "gl");
+
+    struct ShaderFile {
+        fs::path path;
+        ShaderFormat format;
+        Sha256Hash hash;
+    };
+    std::vector<ShaderFile> shader_files;
+
+    const std::string glsl_prefix = fmt::format("{}-", renderer.shader_version);
+    const std::string spirv_prefix = is_vulkan ? fmt::format("vk{}-", shader::CURRENT_VERSION) : fmt::format("{}spv-", renderer.shader_version);
+    boost::system::error_code ec;
+    for (const auto &file : fs::directory_iterator(renderer.shaders_path, ec)) {
+        const fs::path &file_path = file.path();
+        const std::string extension = file_path.extension().string();
+        const std::string stem = file_path.stem().string();
+
+        ShaderFormat format;
+        std::string_view prefix;
+        if (extension == ".spv") {
+            format = ShaderFormat::SPIRV;
+            prefix = spirv_prefix;
+        } else if (!is_vulkan && (extension == ".frag" || extension == ".vert")) {
+            format = ShaderFormat::GLSL;
+            prefix = glsl_prefix;
+        } else {
+            continue;
+        }
+
+        Sha256Hash hash;
+        if (stem.starts_with(prefix) && parse_hash(std::string_view(stem).substr(prefix.size()), hash))
+            shader_files.push_back({ file_path, format, hash });
     }
 
-    if (destination == nullptr) {
-        return true;
+    if (shader_files.empty() && !fs::exists(hashs_path))
+        return;
+
+    // the shaders can't be used if the list of programs was saved for another version or other features
+    std::vector<std::array<Sha256Hash, 2>> programs;
+    bool is_outdated = false;
+    fs::ifstream shaders_hashs(hashs_path, std::ios::in | std::ios::binary);
+    if (shaders_hashs.is_open()) {
+        size_t size = 0;
+        uint32_t versionInFile = 0;
+        uint32_t features_mask = 0;
+        shaders_hashs.read((char *)&size, sizeof(size));
+        shaders_hashs.read((char *)&versionInFile, sizeof(uint32_t));
+        shaders_hashs.read((char *)&features_mask, sizeof(uint32_t));
+        is_outdated = !shaders_hashs || versionInFile != shader::CURRENT_VERSION || features_mask != renderer.get_features_mask();
+
+        std::array<Sha256Hash, 2> program;
+        for (size_t a = 0; a < size && !is_outdated; a++) {
+            shaders_hashs.read(reinterpret_cast<char *>(program.data()), sizeof(program));
+            if (!shaders_hashs)
+                break;
+            programs.push_back(program);
+        }
+        shaders_hashs.close();
     }
 
-    is.read(*destination, size_read);
-    return true;
-}
+    std::map<Sha256Hash, Xxh128Hash> new_hashs;
+    if (!is_outdated) {
+        for (const auto &file : fs::directory_iterator(renderer.shaders_log_path, ec)) {
+            const std::string stem = file.path().stem().string();
+            const size_t separator = stem.rfind('-');
+            Sha256Hash hash;
+            std::vector<uint8_t> gxp;
+            if (file.path().extension() == ".gxp" && separator != std::string::npos && parse_hash(std::string_view(stem).substr(separator + 1), hash)
+                && fs_utils::read_data(file.path(), gxp))
+                new_hashs[hash] = xxh128(gxp.data(), gxp.size());
+        }
+    }
 
-static Sha256Hash get_shader_hash(const SceGxmProgram &program) {
-    const Sha256Hash hash_bytes = sha256(&program, program.size);
-    return hash_bytes;
-}
+    const auto get_new_hash = [&](const Sha256Hash &hash, Xxh128Hash &new_hash) {
+        if (hash == Sha256Hash{}) {
+            // the programs listed by vulkan only have one of their shaders
+            new_hash = {};
+            return true;
+        }
+
+        const auto it = new_hashs.find(hash);
+        if (it == new_hashs.end())
+            return false;
+
+        new_hash = it->second;
+        return true;
+    };
 
-template <typename R>
-static R load_shader_generic(const fs::path &shader_path) {
-    std::size_t read_size = 0;
-    R source;
+    size_t shaders_imported = 0;
+    for (const ShaderFile &shader_file : shader_files) {
+        Xxh128Hash hash;
+        std::vector<uint8_t> data;
+        if (get_new_hash(shader_file.hash, hash) && !renderer.shader_archive.contains(shader_file.format, hash)
+            && fs_utils::read_data(shader_file.path, data) && !data.empty()) {
+            renderer.shader_archive.save(shader_file.format, hash, data.data(), static_cast<uint32_t>(data.size()));
+            shaders_imported++;
+        }
+        fs::remove(shader_file.path, ec);
+    }
 
-    if (load_shader(shader_path, nullptr, read_size)) {
-        source.resize((read_size + sizeof(typename R::value_type) - 1) / sizeof(typename R::value_type));
+    size_t programs_imported = 0;
+    for (const auto &program : programs) {
+        ShadersHash hash;
+        if (get_new_hash(program[0], hash.frag) && get_new_hash(program[1], hash.vert)) {
+            renderer.shaders_cache_hashs.push_back(hash);
+            programs_imported++;
+        }
+    }
 
-        char *dest_pointer = reinterpret_cast<char *>(source.data());
-        load_shader(shader_path, &dest_pointer, read_size);
+    if (programs_imported > 0) {
+        save_shaders_cache_hashs(renderer, renderer.shaders_cache_hashs);
+        if (is_vulkan)
+            dynamic_cast<vulkan::VKState &>(renderer).pipeline_cache.read_pipeline_cache();
     }
+    fs::remove(hashs_path, ec);
 
-    return source;
+    LOG_INFO("Imported {}/{} shaders and {}/{} programs from the sha256 shader cache", shaders_imported, shader_files.size(), programs_imported, programs.size());
 }
 
-static shader::GeneratedShader load_shader_generic(shader::Target target, const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shaderlog_path, const char *shader_type_str, const std::string &shader_version, bool shader_cache) {
-    // TODO: no need to recompute the hash here
-    const std::string hash_text = hex_string(get_shader_hash(program));
-    // Set Shader Hash with Version
-    const std::string hash_hex_ver = fmt::format("{}-{}", shader_version, hash_text);
-    const auto get_shader_path = [&](const char *ext) {
-        return shader_cache_path / fmt::format("{}.{}", hash_hex_ver, ext);
-    };
-    const auto get_shaderlog_path = [&](const char *ext) {
-        return shaderlog_path / fmt::format("{}.{}", hash_hex_ver, ext);
-    };
+bool get_shaders_cache_hashs(State &renderer) {
+    // the archive is closed first as the shaders folder is deleted if the cache is outdated
+    renderer.shader_archive.close();
+    renderer.shaders_cache_hashs.clear();
+    read_shaders_cache_hashs(renderer);
+
+    const std::string archive_name = fmt::format("shaders-{}.bin", (renderer.current_backend == Backend::OpenGL) ? "gl" : "vk");
+    if (renderer.shader_archive.open(renderer.shaders_path / archive_name, shader::CURRENT_VERSION))
+        import_sha256_shader_cache(renderer);
+    else
+        LOG_ERROR("Failed to open the shader archive, translated shaders will not be cached");
 
-    const auto shader_path = get_shader_path(shader_type_str);
+    return !renderer.shaders_cache_hashs.empty();
+}
+
+static shader::GeneratedShader load_shader_generic(shader::Target target, const SceGxmProgram &program, const Xxh128Hash &hash, const FeatureState &features, const shader::Hints &hints, bool maskupdate, ShaderArchive &shader_archive, const fs::path &shaderlog_path, const char *shader_type_str, const std::string &shader_version, bool shader_cache) {
+    const ShaderFormat format = (target == shader::Target::GLSLOpenGL) ? ShaderFormat::GLSL : ShaderFormat::SPIRV;
     if (shader_cache) {
-        if (target == shader::Target::GLSLOpenGL) {
-            std::string source = load_shader_generic<std::string>(shader_path);
+        if (format == ShaderFormat::GLSL) {
+            std::string source = shader_archive.load_glsl(hash);
             if (!source.empty()) {
                 return { source, std::vector<uint32_t>() };
             }
         } else {
-            std::vector<uint32_t> source = load_shader_generic<std::vector<uint32_t>>(get_shader_path("spv"));
+            std::vector<uint32_t> source = shader_archive.load_spirv(hash);
             if (!source.empty())
                 return { "", source };
         }
     }
 
+    const std::string hash_text = hex_string(hash);
     LOG_INFO("Generating {} shader {}", shader_type_str, hash_text);
 
     fs::create_directories(shaderlog_path);
 
-    auto shader_log_path = get_shaderlog_path("gxp");
+    // Set Shader Hash with Version
+    auto shader_log_path = shaderlog_path / fmt::format("{}-{}.gxp", shader_version, hash_text);
 
     // Dump gxp binary
     fs_utils::dump_data(shader_log_path, &program, program.size);
     const auto write_data_with_ext = [&](const std::string &ext, const std::string &data) {
-        fs::path out_path;
-        if (ext == shader_type_str) {
-            out_path = shader_path;
-        } else {
-            out_path = shader_log_path;
-            out_path.replace_extension(ext);
-        }
+        // the glsl source itself is saved in the archive
+        if (ext == shader_type_str)
+            return true;
+
+        fs::path out_path = shader_log_path;
+        out_path.replace_extension(ext);
         fs_utils::dump_data(out_path, data.c_str(), data.size());
         return true;
     };
@@ -206,18 +317,15 @@ static shader::GeneratedShader load_shader_generic(shader::Target target, const
     shader::GeneratedShader source = shader::convert_gxp(program, hash_text, features, target, hints, maskupdate, false, write_data_with_ext);
 
     // Copy shader generate to shaders cache
-    const auto shaders_cache_path = fs::path(shader_cache_path);
-    fs::create_directories(shaders_cache_path);
-
-    if (target != shader::Target::GLSLOpenGL) {
-        const auto shader_dst_path = get_shader_path("spv");
-        fs_utils::dump_data(shader_dst_path, source.spirv.data(), sizeof(uint32_t) * source.spirv.size());
-    }
+    if (format == ShaderFormat::GLSL)
+        shader_archive.save(format, hash, source.glsl.data(), static_cast<uint32_t>(source.glsl.size()));
+    else
+        shader_archive.save(format, hash, source.spirv.data(), static_cast<uint32_t>(sizeof(uint32_t) * source.spirv.size()));
 
     return source;
 }
 
-std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
+std::string load_glsl_shader(const SceGxmProgram &program, const Xxh128Hash &hash, const FeatureState &features, const shader::Hints &hints, bool maskupdate, ShaderArchive &shader_archive, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
     SceGxmProgramType program_type = program.get_type();
 
     auto shader_type_to_str = [](SceGxmProgramType type) {
@@ -226,25 +334,17 @@ std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &f
 
     const char *shader_type_str = shader_type_to_str(program_type);
 
-    return load_shader_generic(shader::Target::GLSLOpenGL, program, features, hints, maskupdate, shader_cache_path, shader_log_path, shader_type_str, shader_version, shader_cache).glsl;
+    return load_shader_generic(shader::Target::GLSLOpenGL, program, hash, features, hints, maskupdate, shader_archive, shader_log_path, shader_type_str, shader_version, shader_cache).glsl;
 }
 
-std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
+std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const Xxh128Hash &hash, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, ShaderArchive &shader_archive, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
     const shader::Target target = is_vulkan ? shader::Target::SpirVVulkan : shader::Target::SpirVOpenGL;
     auto shader_type_to_str = [](SceGxmProgramType type) {
         return (type == SceGxmProgramType::Vertex) ? "vert.spv.txt" : ((type == SceGxmProgramType::Fragment) ? "frag.spv.txt" : "unknown.spv.txt");
     };
     const char *shader_type_str = shader_type_to_str(program.get_type());
 
-    return load_shader_generic(target, program, features, hints, maskupdate, shader_cache_path, shader_log_path, shader_type_str, shader_version, shader_cache).spirv;
-}
-
-std::string pre_load_shader_glsl(const fs::path &shader_path) {
-    return load_shader_generic<std::string>(shader_path);
-}
-
-std::vector<uint32_t> pre_load_shader_spirv(const fs::path &shader_path) {
-    return load_shader_generic<std::vector<uint32_t>>(shader_path);
+    return load_shader_generic(target, program, hash, features, hints, maskupdate, shader_archive, shader_log_path, shader_type_str, shader_version, shader_cache).spirv;
 }
 
 } // namespace renderer
@@ -51,9 +51,19 @@ static uint64_t hash_palette_data(const SceGxmTexture &texture, size_t count, co
     return hash_data(palette_bytes, count * sizeof(uint32_t));
 }
 
+// return 0 if the texture has no palette
+static uint64_t hash_texture_palette(const SceGxmTexture &texture, const MemState &mem) {
+    switch (gxm::get_base_format(gxm::get_format(texture))) {
+    case SCE_GXM_TEXTURE_BASE_FORMAT_P4:
+        return hash_palette_data(texture, 16, mem);
+    case SCE_GXM_TEXTURE_BASE_FORMAT_P8:
+        return hash_palette_data(texture, 256, mem);
+    default:
+        return 0;
+    }
+}
+
 uint64_t hash_texture_data(const SceGxmTexture &texture, uint32_t texture_size, const MemState &mem) {
-    const SceGxmTextureFormat format = gxm::get_format(texture);
-    const SceGxmTextureBaseFormat base_format = gxm::get_base_format(format);
     const Ptr<const void> data(texture.data_addr << 2);
     uint64_t data_hash = 0;
 
@@ -61,14 +71,7 @@ uint64_t hash_texture_data(const SceGxmTexture &texture, uint32_t texture_size,
         data_hash = hash_data(data.get(mem), texture_size);
     }
 
-    switch (base_format) {
-    case SCE_GXM_TEXTURE_BASE_FORMAT_P4:
-        return data_hash ^ hash_palette_data(texture, 16, mem);
-    case SCE_GXM_TEXTURE_BASE_FORMAT_P8:
-        return data_hash ^ hash_palette_data(texture, 256, mem);
-    default:
-        return data_hash;
-    }
+    return data_hash ^ hash_texture_palette(texture, mem);
 }
 
 // Function to hash an arbitrary swizzled texture in the most optimized way possible
@@ -291,6 +294,124 @@ uint16_t get_upload_mip(const uint16_t true_mip, const uint16_t width, const uin
 
 using namespace texture;
 
+DecodedTextureCache::Data DecodedTextureCache::get(uint64_t key) {
+    auto it = lookup.find(key);
+    if (it == lookup.end())
+        return {};
+
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->data;
+}
+
+void DecodedTextureCache::insert(uint64_t key, Data data) {
+    if (data->size() > DecodedTextureCacheSize || lookup.find(key) != lookup.end())
+        return;
+
+    total_size += data->size();
+    entries.push_front({ key, std::move(data) });
+    lookup[key] = entries.begin();
+
+    while (total_size > DecodedTextureCacheSize) {
+        const Entry &lru = entries.back();
+        total_size -= lru.data->size();
+        lookup.erase(lru.key);
+        entries.pop_back();
+    }
+}
+
+void TextureCache::track_texture_pages(TextureCacheInfo &info, const SceGxmTexture &gxm_texture, MemState &mem) {
+    const Address data_addr = gxm_texture.data_addr << 2;
+    if (data_addr == 0)
+        return;
+
+    // the pages the texture shares with other data are not protected, they are hashed every time
+    const Address pages_begin = align(data_addr, mem.page_size);
+    const Address pages_end = align_down(data_addr + info.texture_size, mem.page_size);
+    // not worth it for small textures
+    if (pages_end < pages_begin + mem.page_size * 4)
+        return;
+
+    const size_t nb_pages = (pages_end - pages_begin) / mem.page_size;
+    auto tracker = std::make_shared<TexturePageTracker>();
+    tracker->start = pages_begin;
+    tracker->page_hashes.resize(nb_pages);
+    tracker->dirty = std::make_unique<std::atomic<bool>[]>(nb_pages);
+    // all the pages still need to be protected and hashed
+    for (size_t page = 0; page < nb_pages; page++)
+        tracker->dirty[page] = true;
+
+    info.page_tracker = std::move(tracker);
+}
+
+uint64_t TextureCache::hash_texture_pages(TextureCacheInfo &info, const SceGxmTexture &gxm_texture, MemState &mem) {
+    TexturePageTracker &tracker = *info.page_tracker;
+    const Address data_addr = gxm_texture.data_addr << 2;
+    const Address data_end = data_addr + info.texture_size;
+    const Address pages_end = tracker.start + static_cast<Address>(tracker.page_hashes.size()) * mem.page_size;
+
+    uint64_t dirty_pages = 0;
+    for (size_t page = 0; page < tracker.page_hashes.size(); page++) {
+        if (!tracker.dirty[page].exchange(false))
+            continue;
+
+        // protect the page before hashing it so no write can be missed
+        const Address page_addr = tracker.start + static_cast<Address>(page) * mem.page_size;
+        add_protect(mem, page_addr, mem.page_size, MemPerm::ReadOnly, [tracker = info.page_tracker, page](Address, bool) {
+            tracker->dirty[page] = true;
+            return true;
+        });
+        tracker.page_hashes[page] = hash_data(Ptr<const uint8_t>(page_addr).get(mem), mem.page_size);
+        dirty_pages++;
+    }
+
+    static XXH3_state_t *hash_state = XXH3_createState();
+    XXH3_64bits_reset(hash_state);
+    XXH3_64bits_update(hash_state, Ptr<const uint8_t>(data_addr).get(mem), tracker.start - data_addr);
+    XXH3_64bits_update(hash_state, tracker.page_hashes.data(), tracker.page_hashes.size() * sizeof(uint64_t));
+    XXH3_64bits_update(hash_state, Ptr<const uint8_t>(pages_end).get(mem), data_end - pages_end);
+
+    frame_bytes_hashed += (tracker.start - data_addr) + dirty_pages * mem.page_size + (data_end - pages_end);
+    frame_dirty_pages += dirty_pages;
+    frame_clean_pages += tracker.page_hashes.size() - dirty_pages;
+
+    return XXH3_64bits_digest(hash_state) ^ hash_texture_palette(gxm_texture, mem);
+}
+
+uint64_t TextureCache::hash_texture(TextureCacheInfo &info, const SceGxmTexture &gxm_texture, MemState &mem) {
+    if (import_textures || export_textures) {
+        frame_bytes_hashed += info.texture_size;
+        return hash_texture_nostride(gxm_texture, mem);
+    }
+
+    if (info.page_tracker)
+        return hash_texture_pages(info, gxm_texture, mem);
+
+    frame_bytes_hashed += info.texture_size;
+    // the xor 1 is to make sure it won't be the same as hash_texture_nostride
+    return hash_texture_data(gxm_texture, info.texture_size, mem) ^ 1;
+}
+
+TextureHashStats TextureCache::end_frame() {
+    const TextureHashStats stats = {
+        .bytes_hashed = frame_bytes_hashed.exchange(0),
+        .dirty_pages = frame_dirty_pages.exchange(0),
+        .clean_pages = frame_clean_pages.exchange(0),
+    };
+
+    logged_hash_stats.bytes_hashed += stats.bytes_hashed;
+    logged_hash_stats.dirty_pages += stats.dirty_pages;
+    logged_hash_stats.clean_pages += stats.clean_pages;
+    constexpr uint32_t frames_between_logs = 600;
+    if (++logged_frames == frames_between_logs) {
+        LOG_DEBUG("Texture hashing: {} KiB per frame, {} dirty pages, {} clean pages",
+            logged_hash_stats.bytes_hashed / frames_between_logs / 1024, logged_hash_stats.dirty_pages, logged_hash_stats.clean_pages);
+        logged_hash_stats = {};
+        logged_frames = 0;
+    }
+
+    return stats;
+}
+
 bool TextureCache::init(const bool hashless_texture_cache, const fs::path &texture_folder, std::string_view game_id, const size_t sampler_cache_size) {
     use_protect = hashless_texture_cache;
 
@@ -346,6 +467,7 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
 
     std::vector<uint8_t> texture_data_decompressed;
     std::vector<uint8_t> texture_pixels_lineared;
+    DecodedTextureCache::Data texture_data_decoded;
 
     const void *pixels = nullptr;
 
@@ -460,18 +582,42 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
         case SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP:
         case SCE_GXM_TEXTURE_BASE_FORMAT_PVRT4BPP:
         case SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP:
-        case SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP:
+        case SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP: {
             if (!is_swizzled)
                 LOG_ERROR_ONCE("Unhandled non-swizzled PVRT format, please report it to the developers");
 
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
-            // this actually also unswizzles the texture
-            decompress_compressed_texture(base_format, texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
+            // the hash is only up to date for textures which are not protected
+            const bool use_decoded_cache = current_info && current_info->use_hash;
+            uint64_t decoded_key = 0;
+            if (use_decoded_cache) {
+                const struct {
+                    uint64_t hash;
+                    uint32_t format;
+                    uint32_t width;
+                    uint32_t height;
+                    uint32_t mip_index;
+                    int32_t face;
+                    uint32_t padding;
+                } key = { current_info->hash, base_format, pixels_per_stride, memory_height, mip_index, upload_type, 0 };
+                decoded_key = XXH3_64bits(&key, sizeof(key));
+                texture_data_decoded = decoded_textures.get(decoded_key);
+            }
+
+            if (!texture_data_decoded) {
+                auto decoded = std::make_shared<std::vector<uint8_t>>(pixels_per_stride * memory_height * 4);
+                // this actually also unswizzles the texture
+                decompress_compressed_texture(base_format, decoded->data(), pixels, pixels_per_stride, memory_height);
+                texture_data_decoded = decoded;
+                if (use_decoded_cache)
+                    decoded_textures.insert(decoded_key, texture_data_decoded);
+            }
+
             bytes_per_pixel = 4;
             bpp = 32;
             upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8;
-            pixels = texture_data_decompressed.data();
+            pixels = texture_data_decoded->data();
             break;
+        }
         case SCE_GXM_TEXTURE_BASE_FORMAT_U8U3U3U2:
             // Convert U8U3U3U2 to U8U8U8U8
             texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
@@ -669,12 +815,11 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         }
 
         info->use_hash = should_use_hash;
+        info->page_tracker.reset();
         if (info->use_hash) {
-            if (import_textures || export_textures)
-                info->hash = hash_texture_nostride(gxm_texture, mem);
-            else
-                // the xor 1 is to make sure it won't be the same as hash_texture_nostride
-                info->hash = hash_texture_data(gxm_texture, info->texture_size, mem) ^ 1;
+            if (use_incremental_hash)
+                track_texture_pages(*info, gxm_texture, mem);
+            info->hash = hash_texture(*info, gxm_texture, mem);
         }
     } else {
         // Texture is cached.
@@ -683,10 +828,7 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         configure = false;
         if (info->use_hash) {
             const uint64_t previous_hash = info->hash;
-            if (import_textures || export_textures)
-                info->hash = hash_texture_nostride(gxm_texture, mem);
-            else
-                info->hash = hash_texture_data(gxm_texture, info->texture_size, mem) ^ 1;
+            info->hash = hash_texture(*info, gxm_texture, mem);
 
             upload = previous_hash != info->hash;
         } else {
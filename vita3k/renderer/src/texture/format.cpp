@@ -16,6 +16,7 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <bit>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
@@ -24,6 +25,13 @@
 #include <renderer/functions.h>
 #include <renderer/pvrt-dec.h>
 #include <util/log.h>
+#include <util/thread_pool.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
 
 namespace renderer::texture {
 
@@ -321,6 +329,64 @@ uint32_t encode_morton(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
     return result;
 }
 
+// position of the 16 texels of a 4x4 morton block (bit 0 of the index goes to y)
+static constexpr uint8_t MORTON_BLOCK_X[16] = { 0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 3, 3, 2, 2, 3, 3 };
+static constexpr uint8_t MORTON_BLOCK_Y[16] = { 0, 1, 0, 1, 2, 3, 2, 3, 0, 1, 0, 1, 2, 3, 2, 3 };
+
+template <uint32_t bpp>
+static void swizzled_block_to_linear(uint8_t *dest, const uint8_t *src, uint32_t dest_pitch) {
+    // bpp is known at compile time so each memcpy is a single move
+    for (int i = 0; i < 16; i++)
+        memcpy(dest + MORTON_BLOCK_Y[i] * dest_pitch + MORTON_BLOCK_X[i] * bpp, src + i * bpp, bpp);
+}
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || defined(_M_ARM64)
+template <>
+void swizzled_block_to_linear<4>(uint8_t *dest, const uint8_t *src, uint32_t dest_pitch) {
+    // each 16-byte quad is a 2x2 block stored column by column: (0,0) (0,1) (1,0) (1,1)
+    // a row of the 4x4 block is made of the even or odd texels of two quads
+#if defined(__x86_64__) || defined(_M_X64)
+    const __m128 q0 = _mm_loadu_ps(reinterpret_cast<const float *>(src));
+    const __m128 q1 = _mm_loadu_ps(reinterpret_cast<const float *>(src + 16));
+    const __m128 q2 = _mm_loadu_ps(reinterpret_cast<const float *>(src + 32));
+    const __m128 q3 = _mm_loadu_ps(reinterpret_cast<const float *>(src + 48));
+    _mm_storeu_ps(reinterpret_cast<float *>(dest), _mm_shuffle_ps(q0, q2, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(reinterpret_cast<float *>(dest + dest_pitch), _mm_shuffle_ps(q0, q2, _MM_SHUFFLE(3, 1, 3, 1)));
+    _mm_storeu_ps(reinterpret_cast<float *>(dest + 2 * dest_pitch), _mm_shuffle_ps(q1, q3, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(reinterpret_cast<float *>(dest + 3 * dest_pitch), _mm_shuffle_ps(q1, q3, _MM_SHUFFLE(3, 1, 3, 1)));
+#else
+    const uint32_t *src32 = reinterpret_cast<const uint32_t *>(src);
+    const uint32x4x2_t rows01 = vuzpq_u32(vld1q_u32(src32), vld1q_u32(src32 + 8));
+    const uint32x4x2_t rows23 = vuzpq_u32(vld1q_u32(src32 + 4), vld1q_u32(src32 + 12));
+    vst1q_u32(reinterpret_cast<uint32_t *>(dest), rows01.val[0]);
+    vst1q_u32(reinterpret_cast<uint32_t *>(dest + dest_pitch), rows01.val[1]);
+    vst1q_u32(reinterpret_cast<uint32_t *>(dest + 2 * dest_pitch), rows23.val[0]);
+    vst1q_u32(reinterpret_cast<uint32_t *>(dest + 3 * dest_pitch), rows23.val[1]);
+#endif
+}
+#endif
+
+template <uint32_t bpp>
+static void swizzled_texture_to_linear_texture_blocks(uint8_t *dest, const uint8_t *src, uint32_t width, uint32_t height) {
+    const uint32_t min = std::min(width, height);
+    const uint32_t k = std::bit_width(min) - 1;
+    const uint32_t dest_pitch = width * bpp;
+
+    // all the texels of a 4x4 block share the same upper bits, only the position of the block must be decoded
+    for (uint32_t i = 0; i < width * height; i += 16) {
+        uint32_t x = decode_morton2_x(i) & (min - 1);
+        uint32_t y = decode_morton2_y(i) & (min - 1);
+        const uint32_t upper_bits = (i >> (2 * k)) << k;
+        if (width >= height) {
+            x |= upper_bits;
+        } else {
+            y |= upper_bits;
+        }
+
+        swizzled_block_to_linear<bpp>(dest + y * dest_pitch + x * bpp, src + i * bpp, dest_pitch);
+    }
+}
+
 void swizzled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel) {
     if (bits_per_pixel % 8 != 0) {
         // Don't support yet
@@ -331,6 +397,19 @@ void swizzled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint1
     uint32_t min = std::min(width, height);
     uint32_t k = std::bit_width(min) - 1;
 
+    // the block path needs the texture to be made of whole 4x4 morton blocks, min is then a multiple of 4 but the other side may not be
+    if (min >= 4 && std::has_single_bit(min) && std::max(width, height) % 4 == 0) {
+        switch (bytes_per_pixel) {
+        case 1: return swizzled_texture_to_linear_texture_blocks<1>(dest, src, width, height);
+        case 2: return swizzled_texture_to_linear_texture_blocks<2>(dest, src, width, height);
+        case 3: return swizzled_texture_to_linear_texture_blocks<3>(dest, src, width, height);
+        case 4: return swizzled_texture_to_linear_texture_blocks<4>(dest, src, width, height);
+        case 8: return swizzled_texture_to_linear_texture_blocks<8>(dest, src, width, height);
+        case 16: return swizzled_texture_to_linear_texture_blocks<16>(dest, src, width, height);
+        default: break;
+        }
+    }
+
     for (uint32_t i = 0; i < width * static_cast<uint32_t>(height); i++) {
         uint32_t x = decode_morton2_x(i) & (min - 1);
         uint32_t y = decode_morton2_y(i) & (min - 1);
@@ -355,16 +434,18 @@ void tiled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t
     const uint32_t bpp = bits_per_pixel >> 3;
     const uint32_t width_in_tiles = (width + 31) >> 5;
 
-    for (uint16_t y = 0; y < height; y++) {
-        for (uint16_t x = 0; x < width; x++) {
-            // Calculate texel address in tile
-            const uint32_t texel_offset_in_tile = (x & 0b11111) | ((y & 0b11111) << 5);
-            const uint32_t tile_address = (x >> 5) + width_in_tiles * (y >> 5);
+    // each row of a tile is contiguous, copy it at once
+    for (uint32_t y = 0; y < height; y++) {
+        const uint32_t row_offset_in_tile = (y & 0b11111) << 5;
+        const uint32_t first_tile = width_in_tiles * (y >> 5);
+        uint8_t *dest_row = dest + y * width * bpp;
 
-            const uint32_t offset = ((tile_address << 10) | (texel_offset_in_tile)) * bpp;
+        for (uint32_t tile_x = 0; tile_x < width_in_tiles; tile_x++) {
+            const uint32_t x = tile_x << 5;
+            const uint32_t texel_count = std::min(32U, width - x);
+            const uint32_t offset = (((first_tile + tile_x) << 10) | row_offset_in_tile) * bpp;
 
-            // Make scanline
-            memcpy(dest + ((y * width) + x) * bpp, src + offset, bpp);
+            memcpy(dest_row + x * bpp, src + offset, texel_count * bpp);
         }
     }
 }
@@ -672,21 +753,29 @@ void decompress_bc_image(uint32_t width, uint32_t height, const uint8_t *block_s
     const uint32_t block_size = (format_id != 1 && format_id != 4 && format_id != 5) ? 16 : 8;
     const uint32_t line_size = block_count_x * 4;
 
-    auto decompress_bcn = [=, &block_storage]<typename T, typename F>(T _, F decompress_func) {
-        T temp_block_result[16] = {};
+    // rows of blocks are independent, decompress them in parallel
+    constexpr uint32_t ROWS_PER_STRIPE = 16;
+    const uint32_t stripe_count = (block_count_y + ROWS_PER_STRIPE - 1) / ROWS_PER_STRIPE;
 
-        for (uint32_t j = 0; j < block_count_y; j++) {
-            for (uint32_t i = 0; i < block_count_x; i++) {
-                decompress_func(block_storage, temp_block_result);
+    auto decompress_bcn = [=]<typename T, typename F>(T _, F decompress_func) {
+        util::get_worker_pool().parallel_for(stripe_count, [&](uint32_t stripe) {
+            T temp_block_result[16] = {};
 
-                const uint32_t offset = j * 4 * line_size + i * 4;
-                for (uint32_t delta = 0; delta < 16; delta++) {
-                    image[offset + (delta % 4) + ((delta / 4) * line_size)] = temp_block_result[delta];
-                }
+            const uint32_t last_row = std::min((stripe + 1) * ROWS_PER_STRIPE, block_count_y);
+            for (uint32_t j = stripe * ROWS_PER_STRIPE; j < last_row; j++) {
+                const uint8_t *block = block_storage + j * block_count_x * block_size;
+                for (uint32_t i = 0; i < block_count_x; i++) {
+                    decompress_func(block, temp_block_result);
+
+                    const uint32_t offset = j * 4 * line_size + i * 4;
+                    for (uint32_t delta = 0; delta < 16; delta++) {
+                        image[offset + (delta % 4) + ((delta / 4) * line_size)] = temp_block_result[delta];
+                    }
 
-                block_storage += block_size;
+                    block += block_size;
+                }
             }
-        }
+        });
     };
 
     switch (format_id) {
@@ -734,22 +823,8 @@ void resolve_z_order_compressed_image(uint32_t width, uint32_t height, const uin
     uint32_t block_count_x = (width + 3) / 4;
     uint32_t block_count_y = (height + 3) / 4;
 
-    uint32_t min = std::min(block_count_x, block_count_y);
-    uint32_t k = std::bit_width(min) - 1;
-
-    uint32_t block_count = block_count_x * block_count_y;
-    for (uint32_t i = 0; i < block_count; i++) {
-        uint32_t x = decode_morton2_x(i) & (min - 1);
-        uint32_t y = decode_morton2_y(i) & (min - 1);
-        uint32_t upper_bits = (i >> (2 * k)) << k;
-        if (block_count_x >= block_count_y) {
-            x |= upper_bits;
-        } else {
-            y |= upper_bits;
-        }
-
-        std::memcpy(dest + (y * block_count_x + x) * block_size, src + i * block_size, block_size);
-    }
+    // compressed blocks are swizzled like texels
+    swizzled_texture_to_linear_texture(dest, src, block_count_x, block_count_y, block_size * 8);
 }
 
 } // namespace renderer::texture
@@ -56,8 +56,29 @@ static void perform_transfer_copy_impl(MemState &mem, const SceGxmTransferImage
         }
     };
 
-    for (uint32_t dx = 0; dx < src.width; dx++) {
+    if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_NONE && src_type != SCE_GXM_TRANSFER_SWIZZLED && dst_type != SCE_GXM_TRANSFER_SWIZZLED) {
+        // texels are contiguous along a linear row and along the 32 texels of a tile row, copy whole runs
         for (uint32_t dy = 0; dy < src.height; dy++) {
+            uint32_t dx = 0;
+            while (dx < src.width) {
+                uint32_t run = src.width - dx;
+                if constexpr (src_type == SCE_GXM_TRANSFER_TILED)
+                    run = std::min(run, 32 - (src.x + dx) % 32);
+                if constexpr (dst_type == SCE_GXM_TRANSFER_TILED)
+                    run = std::min(run, 32 - (dst.x + dx) % 32);
+
+                const uint32_t src_offset = compute_offset(src.x + dx, src.y + dy, src, src_type);
+                const uint32_t dst_offset = compute_offset(dst.x + dx, dst.y + dy, dst, dst_type);
+                // the source and destination can be the same surface
+                memmove(&dst_ptr[dst_offset], &src_ptr[src_offset], run * sizeof(T));
+                dx += run;
+            }
+        }
+        return;
+    }
+
+    for (uint32_t dy = 0; dy < src.height; dy++) {
+        for (uint32_t dx = 0; dx < src.width; dx++) {
             // compute offset depending on the texture type used
             // the function compute_offset gets inlined
             uint32_t src_offset = compute_offset(src.x + dx, src.y + dy, src, src_type);
@@ -255,7 +255,9 @@ void PipelineCache::set_async_compilation(bool enable) {
 }
 
 // magic number put at the beginning of the pipeline cache file
-constexpr uint32_t pipeline_cache_magic = 0xBEEF4321;
+constexpr uint32_t pipeline_cache_magic = 0xBEEF4322;
+// pipeline cache saved when the programs were identified by their sha256, its pipeline hashes can no longer match
+constexpr uint32_t pipeline_cache_magic_sha256 = 0xBEEF4321;
 
 void PipelineCache::read_pipeline_cache() {
     const std::string pipeline_cache_name = fmt::format("pipeline-cache-vk{}.dat", shader::CURRENT_VERSION);
@@ -284,18 +286,19 @@ void PipelineCache::read_pipeline_cache() {
     read_integer(nb_hashes);
     // safety check
     size_t hashes_size = sizeof(magic_number) + sizeof(nb_hashes) + nb_hashes * sizeof(uint64_t);
-    if (magic_number != pipeline_cache_magic || pipeline_size < hashes_size) {
+    if ((magic_number != pipeline_cache_magic && magic_number != pipeline_cache_magic_sha256) || pipeline_size < hashes_size) {
         LOG_WARN("Pipeline cache is corrupted, ignoring it.");
         pipeline_cache_file.close();
         return;
     }
     pipeline_size -= hashes_size;
 
-    // insert hashes with null pipeline
+    // insert hashes with null pipeline, the driver cache itself does not depend on them
     for (size_t i = 0; i < nb_hashes; i++) {
         uint64_t hash;
         read_integer(hash);
-        pipelines[hash] = nullptr;
+        if (magic_number == pipeline_cache_magic)
+            pipelines[hash] = nullptr;
     }
 
     std::vector<char> pipeline_data(pipeline_size);
@@ -377,7 +380,7 @@ static const vk::SpecializationInfo srgb_info_false = {
     .pData = &srgb_entry_false
 };
 
-vk::PipelineShaderStageCreateInfo PipelineCache::retrieve_shader(const SceGxmProgram *program, const Sha256Hash &hash, bool is_vertex, bool maskupdate, MemState &mem, const shader::Hints &hints, bool is_srgb) {
+vk::PipelineShaderStageCreateInfo PipelineCache::retrieve_shader(const SceGxmProgram *program, const Xxh128Hash &hash, bool is_vertex, bool maskupdate, MemState &mem, const shader::Hints &hints, bool is_srgb) {
     if (maskupdate)
         LOG_CRITICAL("Mask not implemented in the vulkan renderer!");
 
@@ -428,7 +431,7 @@ vk::PipelineShaderStageCreateInfo PipelineCache::retrieve_shader(const SceGxmPro
     LOG_INFO("Generating vulkan spv shader {}", hash_text);
     const std::string shader_version = fmt::format("vk{}", shader::CURRENT_VERSION);
 
-    shader::usse::SpirvCode source = load_spirv_shader(*program, state.features, true, hints, maskupdate, state.shaders_path, state.shaders_log_path, shader_version, true);
+    shader::usse::SpirvCode source = load_spirv_shader(*program, hash, state.features, true, hints, maskupdate, state.shader_archive, state.shaders_log_path, shader_version, true);
 
     vk::ShaderModuleCreateInfo shader_info{
         .codeSize = sizeof(uint32_t) * source.size(),
@@ -440,7 +443,7 @@ vk::PipelineShaderStageCreateInfo PipelineCache::retrieve_shader(const SceGxmPro
         std::lock_guard<std::mutex> guard(shaders_mutex);
         // Save shader cache hashes
         // vertex and fragment shaders are not linked together so no need to associate them
-        Sha256Hash empty_hash{};
+        Xxh128Hash empty_hash{};
         if (is_vertex) {
             state.shaders_cache_hashs.push_back({ hash, empty_hash });
         } else {
@@ -923,21 +926,16 @@ vk::Pipeline PipelineCache::retrieve_pipeline(VKContext &context, SceGxmPrimitiv
     }
 }
 
-vk::ShaderModule PipelineCache::precompile_shader(const Sha256Hash &hash, bool search_first) {
+vk::ShaderModule PipelineCache::precompile_shader(const Xxh128Hash &hash, bool search_first) {
     if (search_first) {
-        // happens while loading the thread, no parallel access so no need for a mutex
+        // happens while precompiling the shaders, the same shader can be shared by programs loaded in parallel
+        std::lock_guard<std::mutex> guard(shaders_mutex);
         auto it = shaders.find(hash);
         if (it != shaders.end())
             return it->second;
     }
 
-    if (!fs::exists(state.shaders_path) || fs::is_empty(state.shaders_path))
-        return nullptr;
-
-    Sha256Hash shader_hash;
-    memcpy(shader_hash.data(), hash.data(), sizeof(Sha256Hash));
-    const std::string shader_file_name = fmt::format("vk{}-{}.spv", shader::CURRENT_VERSION, hex_string(shader_hash));
-    const std::vector<uint32_t> source = renderer::pre_load_shader_spirv(state.shaders_path / shader_file_name);
+    const std::vector<uint32_t> source = state.shader_archive.load_spirv(hash);
 
     if (source.empty())
         return nullptr;
@@ -950,7 +948,13 @@ vk::ShaderModule PipelineCache::precompile_shader(const Sha256Hash &hash, bool s
     vk::ShaderModule shader = state.device.createShaderModule(shader_info);
     {
         std::lock_guard<std::mutex> guard(shaders_mutex);
-        shaders[hash] = shader;
+        if (!search_first) {
+            shaders[hash] = shader;
+        } else if (const auto [it, inserted] = shaders.try_emplace(hash, shader); !inserted) {
+            // another worker created the same shader meanwhile
+            state.device.destroyShaderModule(shader);
+            return it->second;
+        }
     }
 
     return shader;
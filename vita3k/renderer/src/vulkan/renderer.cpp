@@ -26,10 +26,14 @@
 #include <shader/spirv_recompiler.h>
 #include <util/align.h>
 #include <util/log.h>
+#include <util/thread_pool.h>
 #include <vkutil/vkutil.h>
 
 #include <SDL_vulkan.h>
 
+#include <chrono>
+#include <thread>
+
 #ifdef __APPLE__
 #include <MoltenVK/mvk_vulkan.h>
 #endif
@@ -648,6 +652,7 @@ void VKState::late_init(const Config &cfg, const std::string_view game_id, MemSt
     pipeline_cache.init();
 
     texture_cache.init(false, texture_folder(), game_id);
+    texture_cache.use_incremental_hash = cfg.incremental_texture_hash;
 }
 
 void VKState::cleanup() {
@@ -678,6 +683,8 @@ void VKState::render_frame(const SceFVector2 &viewport_pos, const SceFVector2 &v
     if (!frame.base)
         return;
 
+    texture_cache.end_frame();
+
     if (!screen_renderer.acquire_swapchain_image())
         return;
 
@@ -961,17 +968,30 @@ std::string_view VKState::get_gpu_name() {
     return physical_device_properties.deviceName.data();
 }
 
-void VKState::precompile_shader(const ShadersHash &hash) {
-    Sha256Hash empty_hash{};
-    if (hash.vert != empty_hash) {
-        pipeline_cache.precompile_shader(hash.vert);
-    }
-    if (hash.frag != empty_hash) {
-        pipeline_cache.precompile_shader(hash.frag);
+void VKState::precompile_shaders(const std::function<void()> &draw_progress) {
+    // creating a shader module does not need the device to be externally synchronized,
+    // so the shaders are loaded and created by the worker pool
+    std::atomic<uint32_t> programs_left = static_cast<uint32_t>(shaders_cache_hashs.size());
+    for (const ShadersHash &hash : shaders_cache_hashs) {
+        util::get_worker_pool().push([this, &hash, &programs_left]() {
+            const Xxh128Hash empty_hash{};
+            if (hash.vert != empty_hash) {
+                pipeline_cache.precompile_shader(hash.vert);
+            }
+            if (hash.frag != empty_hash) {
+                pipeline_cache.precompile_shader(hash.frag);
+            }
+
+            const uint32_t programs_count = ++programs_count_pre_compiled;
+            LOG_INFO("Program Compiled {}/{}", programs_count, shaders_cache_hashs.size());
+            programs_left.fetch_sub(1, std::memory_order_release);
+        });
     }
 
-    programs_count_pre_compiled++;
-    LOG_INFO("Program Compiled {}/{}", programs_count_pre_compiled, shaders_cache_hashs.size());
+    while (programs_left.load(std::memory_order_acquire) > 0) {
+        draw_progress();
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
 }
 
 void VKState::preclose_action() {
@@ -18,109 +18,330 @@
 #ifndef queue_h
 #define queue_h
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
-#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
+#include <thread>
 
+/**
+ * \brief Lock-free queue with blocking waits, bounded or not.
+ *
+ * Items are stored in a ring of slots, each carrying a sequence number telling whether it is ready to be
+ * written or read, so producers and consumers only synchronize through atomics (Dmitry Vyukov's bounded
+ * queue). A full bounded queue blocks the producers and an empty one the consumers, using atomic waits which
+ * are backed by futexes and skipped entirely when nobody is waiting.
+ *
+ * The ring has at least 2 slots, with a single slot the sequence of a written slot would be the same as the
+ * one of a free slot on the next lap. A capacity of 1 is enforced by counting the pending items instead.
+ * An unbounded queue spills the items which don't fit in the ring to a locked list, only used while the
+ * consumers are late.
+ *
+ * Any number of threads can push and pop, but top() is only valid when there is a single consumer.
+ */
 template <typename T>
 class Queue {
 public:
-    // default value: unlimited
-    unsigned int maxPendingCount_ = -1;
+    static constexpr size_t UNBOUNDED = 0;
 
-    std::unique_ptr<T> top(const int ms = 0) {
-        T item{ T() };
+    explicit Queue(size_t capacity = UNBOUNDED) {
+        set_capacity(capacity);
+    }
+    Queue(const Queue &) = delete; // disable copying
+    Queue &operator=(const Queue &) = delete; // disable assignment
+
+    // Change the maximum number of pending items (UNBOUNDED = no limit), the queue must be empty and not used by any other thread
+    void set_capacity(size_t capacity) {
+        constexpr size_t UNBOUNDED_RING_SIZE = 1024;
+        const size_t new_ring_size = capacity == UNBOUNDED ? UNBOUNDED_RING_SIZE : std::max<size_t>(capacity, 2);
+        limit = capacity;
+        counted = capacity != UNBOUNDED && capacity < new_ring_size;
+        pending = 0;
+        if (slots && ring_size == new_ring_size)
+            return;
+
+        ring_size = new_ring_size;
+        slots = std::make_unique<Slot[]>(ring_size);
+        for (size_t i = 0; i < ring_size; i++)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        head = 0;
+        tail = 0;
+    }
+
+    // Return a copy of the next item without removing it, waiting for at most us microseconds (0 = no limit)
+    // Only valid with a single consumer, another one could pop the item while it is copied
+    std::optional<T> top(const int us = 0) {
+        return wait_item(us, [&]() { return try_top(); });
+    }
+
+    // Remove and return the next item, waiting for at most us microseconds (0 = no limit)
+    std::optional<T> pop(const int us = 0) {
+        return wait_item(us, [&]() { return try_pop(); });
+    }
+
+    void push(const T &item) {
+        emplace(item);
+    }
+
+    void push(T &&item) {
+        emplace(std::move(item));
+    }
+
+    size_t size() const {
+        const size_t in_ring = tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed);
+        // the two positions are not read atomically, the difference can briefly wrap around
+        return std::min(in_ring, ring_size) + overflow_size.load(std::memory_order_relaxed);
+    }
+
+    void abort() {
+        aborted = true;
+        notify(pushed, push_waiters, true);
+        notify(popped, pop_waiters, true);
+    }
+
+    // Drop the pending items and allow the queue to be used again after an abort
+    void reset() {
+        while (try_pop())
+            ;
+        pending = 0;
+        aborted = false;
+    }
+
+    void wait_empty() {
+        while (!aborted) {
+            pop_waiters++;
+            const uint32_t count = popped.load();
+            const bool empty = is_empty();
+            if (!empty && !aborted)
+                popped.wait(count);
+            pop_waiters--;
+            if (empty)
+                return;
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        std::optional<T> item;
+    };
+
+    template <typename U>
+    void emplace(U &&item) {
+        if (counted && !reserve())
+            return;
+
+        if (limit != UNBOUNDED) {
+            emplace_ring(std::forward<U>(item), true);
+            return;
+        }
+
+        // once items were spilled, the following ones must go after them
+        if (overflow_size.load(std::memory_order_acquire) == 0 && emplace_ring(std::forward<U>(item), false))
+            return;
+
+        // the item was not moved from if it did not fit in the ring
         {
-            std::unique_lock<std::mutex> mlock(mutex_);
-            if (ms == 0) {
-                while (!aborted && queue_.empty()) {
-                    condempty_.wait(mlock);
-                }
-            } else {
-                if (queue_.empty()) {
-                    condempty_.wait_for(mlock, std::chrono::microseconds(ms));
-                }
-            }
-            if (aborted || queue_.empty()) {
-                return {};
+            const std::lock_guard<std::mutex> guard(overflow_mutex);
+            overflow.emplace_back(std::forward<U>(item));
+            overflow_size++;
+        }
+        notify(pushed, push_waiters, false);
+    }
+
+    // Wait until fewer than limit items are pending and count the new one, return false if the queue was aborted
+    bool reserve() {
+        size_t count = pending.load();
+        while (!aborted) {
+            if (count < limit) {
+                if (pending.compare_exchange_weak(count, count + 1))
+                    return true;
+                continue;
             }
 
-            item = queue_.front();
+            pop_waiters++;
+            const uint32_t popped_count = popped.load();
+            if (pending.load() >= limit && !aborted)
+                popped.wait(popped_count);
+            pop_waiters--;
+            count = pending.load();
         }
-        return std::make_unique<T>(item);
+        return false;
     }
 
-    std::unique_ptr<T> pop(const int ms = 0) {
-        T item{ T() };
-        {
-            std::unique_lock<std::mutex> mlock(mutex_);
-            if (ms == 0) {
-                while (!aborted && queue_.empty()) {
-                    condempty_.wait(mlock);
+    // Return false without touching the item if the ring is full and wait is not set, or if the queue was aborted
+    template <typename U>
+    bool emplace_ring(U &&item, const bool wait) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        while (!aborted) {
+            Slot &slot = slots[pos % ring_size];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence - pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.item.emplace(std::forward<U>(item));
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    notify(pushed, push_waiters, false);
+                    return true;
                 }
+            } else if (diff < 0) {
+                // the slot still holds the item from the previous lap: the ring is full
+                if (!wait)
+                    return false;
+                pop_waiters++;
+                const uint32_t count = popped.load();
+                if (slot.sequence.load() == sequence && !aborted)
+                    popped.wait(count);
+                pop_waiters--;
+                pos = tail.load(std::memory_order_relaxed);
             } else {
-                if (queue_.empty()) {
-                    condempty_.wait_for(mlock, std::chrono::microseconds(ms));
-                }
+                // another producer took this slot
+                pos = tail.load(std::memory_order_relaxed);
             }
-            if (aborted || queue_.empty()) {
+        }
+        return false;
+    }
+
+    bool is_empty() const {
+        const size_t pos = head.load(std::memory_order_relaxed);
+        return slots[pos % ring_size].sequence.load(std::memory_order_acquire) != pos + 1 && overflow_size.load(std::memory_order_acquire) == 0;
+    }
+
+    std::optional<T> try_top_ring() {
+        const size_t pos = head.load(std::memory_order_relaxed);
+        Slot &slot = slots[pos % ring_size];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+            return {};
+        return slot.item;
+    }
+
+    std::optional<T> try_top() {
+        std::optional<T> item = try_top_ring();
+        if (item || overflow_size.load(std::memory_order_acquire) == 0)
+            return item;
+
+        const std::lock_guard<std::mutex> guard(overflow_mutex);
+        // the items spilled were pushed after the ones in the ring, which are all visible once the lock is taken
+        item = try_top_ring();
+        if (!item && !overflow.empty())
+            item = overflow.front();
+        return item;
+    }
+
+    std::optional<T> try_pop_ring() {
+        size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot &slot = slots[pos % ring_size];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence - (pos + 1));
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    std::optional<T> item = std::move(slot.item);
+                    slot.item.reset();
+                    slot.sequence.store(pos + ring_size, std::memory_order_release);
+                    if (counted)
+                        pending--;
+                    notify(popped, pop_waiters, false);
+                    return item;
+                }
+            } else if (diff < 0) {
+                // empty
                 return {};
+            } else {
+                // another consumer took this item
+                pos = head.load(std::memory_order_relaxed);
             }
-
-            item = queue_.front();
-            queue_.pop();
         }
-        cond_.notify_all();
-        return std::make_unique<T>(item);
     }
 
-    void push(const T &item) {
+    std::optional<T> try_pop() {
+        std::optional<T> item = try_pop_ring();
+        if (item || overflow_size.load(std::memory_order_acquire) == 0)
+            return item;
+
         {
-            std::unique_lock<std::mutex> mlock(mutex_);
-            while (!aborted && queue_.size() == maxPendingCount_) {
-                cond_.wait(mlock);
+            const std::lock_guard<std::mutex> guard(overflow_mutex);
+            // same as in try_top, the ring must be empty before taking a spilled item
+            item = try_pop_ring();
+            if (item || overflow.empty())
+                return item;
+
+            item.emplace(std::move(overflow.front()));
+            overflow.pop_front();
+            overflow_size--;
+        }
+        notify(popped, pop_waiters, false);
+        return item;
+    }
+
+    template <typename F>
+    std::optional<T> wait_item(const int us, F &&get_item) {
+        if (aborted)
+            return {};
+        std::optional<T> item = get_item();
+        if (item)
+            return item;
+
+        if (us == 0) {
+            while (!aborted) {
+                push_waiters++;
+                const uint32_t count = pushed.load();
+                item = get_item();
+                if (!item && !aborted)
+                    pushed.wait(count);
+                push_waiters--;
+                if (item)
+                    return item;
+                item = get_item();
+                if (item)
+                    return item;
             }
-            if (aborted) {
-                return;
+        } else {
+            // the timeouts used are a few microseconds, less than what it takes to get woken up
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+            while (!aborted && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+                item = get_item();
+                if (item)
+                    return item;
             }
-            queue_.push(item);
         }
-        condempty_.notify_one();
-    }
 
-    size_t size() {
-        return queue_.size();
+        return {};
     }
 
-    void abort() {
-        aborted = true;
-        condempty_.notify_all();
-        cond_.notify_all();
+    static void notify(std::atomic<uint32_t> &counter, const std::atomic<uint32_t> &waiters, bool force) {
+        counter++;
+        if (force || waiters.load() > 0)
+            counter.notify_all();
     }
 
-    void reset() {
-        std::queue<T> empty;
-        std::swap(queue_, empty);
-        aborted = false;
-    }
+    size_t ring_size = 0;
+    std::unique_ptr<Slot[]> slots;
+    // maximum number of pending items, UNBOUNDED if the overflow list is used
+    size_t limit = UNBOUNDED;
+    // set if the limit is smaller than the ring, the pending items are then counted
+    bool counted = false;
+    std::atomic<size_t> pending{ 0 };
 
-    void wait_empty() {
-        std::unique_lock<std::mutex> mlock(mutex_);
-        cond_.wait(mlock, [&]() { return aborted || queue_.empty(); });
-    }
+    // keep the positions written by the producers and the consumers on different cache lines
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    alignas(64) std::atomic<size_t> head{ 0 };
 
-    Queue() = default;
-    Queue(const Queue &) = delete; // disable copying
-    Queue &operator=(const Queue &) = delete; // disable assignment
+    // incremented after each push/pop, these are the values the waiting threads sleep on
+    alignas(64) std::atomic<uint32_t> pushed{ 0 };
+    std::atomic<uint32_t> push_waiters{ 0 };
+    alignas(64) std::atomic<uint32_t> popped{ 0 };
+    std::atomic<uint32_t> pop_waiters{ 0 };
+
+    std::mutex overflow_mutex;
+    std::deque<T> overflow;
+    std::atomic<size_t> overflow_size{ 0 };
 
-private:
-    std::condition_variable cond_;
-    std::condition_variable condempty_;
-    std::queue<T> queue_;
-    std::mutex mutex_;
     std::atomic<bool> aborted{ false };
 };
 
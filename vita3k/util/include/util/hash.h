@@ -22,8 +22,11 @@
 #include <string>
 
 using Sha256Hash = std::array<uint8_t, 32>;
+using Xxh128Hash = std::array<uint8_t, 16>;
 
 Sha256Hash sha256(const void *data, size_t size);
+// XXH3 128-bit hash in its canonical byte order, use it rather than sha256 when the hash is only an identifier
+Xxh128Hash xxh128(const void *data, size_t size);
 typedef std::array<char, 65> Sha256HashText;
 
 void hex_buf(const std::uint8_t *hash, char *dst, const std::size_t source_size);
@@ -0,0 +1,42 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Read-only mapping of a whole file, the position is shared by all its owners like with a FILE
+struct MappedFile {
+    const uint8_t *data = nullptr;
+    uint64_t size = 0;
+    // the fd can be read from the I/O threads and from the guest at the same time
+    std::atomic<int64_t> position = 0;
+
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+};
+
+typedef std::shared_ptr<MappedFile> MappedFilePtr;
+
+// Return an empty pointer if the file could not be mapped
+MappedFilePtr map_file(const fs::path &path);
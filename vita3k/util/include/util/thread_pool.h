@@ -0,0 +1,75 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+// Fixed set of worker threads executing tasks in submission order
+class ThreadPool {
+public:
+    explicit ThreadPool(uint32_t thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    uint32_t size() const {
+        return static_cast<uint32_t>(workers.size());
+    }
+
+    void push(std::function<void()> task);
+
+    template <typename F>
+    auto submit(F &&func) -> std::future<decltype(func())> {
+        auto task = std::make_shared<std::packaged_task<decltype(func())()>>(std::forward<F>(func));
+        auto result = task->get_future();
+        push([task]() { (*task)(); });
+        return result;
+    }
+
+    /**
+     * \brief Call func(i) for every i in [0, count) and wait for all of them to be done.
+     *
+     * The calling thread also processes indices, so this can safely be used from a task of the pool.
+     */
+    void parallel_for(uint32_t count, const std::function<void(uint32_t)> &func);
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    bool stopping = false;
+};
+
+// Pool shared by the emulator for short CPU-bound jobs, with one thread less than the number of cores
+ThreadPool &get_worker_pool();
+
+} // namespace util
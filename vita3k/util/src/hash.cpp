@@ -18,6 +18,14 @@
 #include <util/hash.h>
 
 #include <openssl/evp.h>
+#if defined(__x86_64__) && !defined(__APPLE__)
+#include <xxh_x86dispatch.h>
+#else
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+#endif
+
+#include <cstring>
 
 Sha256Hash sha256(const void *data, size_t size) {
     Sha256Hash hash;
@@ -32,6 +40,17 @@ Sha256Hash sha256(const void *data, size_t size) {
     return hash;
 }
 
+Xxh128Hash xxh128(const void *data, size_t size) {
+    XXH128_canonical_t canonical;
+    XXH128_canonicalFromHash(&canonical, XXH3_128bits(data, size));
+
+    Xxh128Hash hash;
+    static_assert(sizeof(canonical) == sizeof(hash));
+    memcpy(hash.data(), &canonical, sizeof(hash));
+
+    return hash;
+}
+
 void hex_buf(const std::uint8_t *hash, char *dst, const std::size_t source_size) {
     const char hex[17] = "0123456789abcdef";
     size_t j = 0;
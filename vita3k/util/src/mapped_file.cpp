@@ -0,0 +1,89 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <util/mapped_file.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    if (!data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<uint8_t *>(data), size);
+#endif
+}
+
+MappedFilePtr map_file(const fs::path &path) {
+    auto mapped_file = std::make_shared<MappedFile>();
+
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(path.generic_path().wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return {};
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return {};
+    }
+
+    mapped_file->size = file_size.QuadPart;
+    if (mapped_file->size > 0) {
+        // the view keeps a reference to the mapping and the file, they can be closed right away
+        const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            mapped_file->data = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    const int fd = open(path.generic_path().string().c_str(), O_RDONLY);
+    if (fd == -1)
+        return {};
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1) {
+        close(fd);
+        return {};
+    }
+
+    mapped_file->size = file_stat.st_size;
+    if (mapped_file->size > 0) {
+        void *data = mmap(nullptr, mapped_file->size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data != MAP_FAILED)
+            mapped_file->data = static_cast<const uint8_t *>(data);
+    }
+    close(fd);
+#endif
+
+    if (mapped_file->size > 0 && !mapped_file->data)
+        return {};
+
+    return mapped_file;
+}
@@ -0,0 +1,110 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <util/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace util {
+
+ThreadPool::ThreadPool(uint32_t thread_count) {
+    for (uint32_t i = 0; i < thread_count; i++)
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    task_available.notify_one();
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_available.wait(lock, [&]() { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(uint32_t count, const std::function<void(uint32_t)> &func) {
+    if (count == 0)
+        return;
+
+    if (count == 1 || workers.empty()) {
+        for (uint32_t i = 0; i < count; i++)
+            func(i);
+        return;
+    }
+
+    struct Job {
+        std::atomic<uint32_t> next_index = 0;
+        std::atomic<uint32_t> done_count = 0;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    const auto job = std::make_shared<Job>();
+
+    // func is only accessed while some indices are not done, so the caller is still waiting on it
+    auto process = [job, count, &func]() {
+        uint32_t processed = 0;
+        for (uint32_t i = job->next_index++; i < count; i = job->next_index++) {
+            func(i);
+            processed++;
+        }
+
+        if (processed > 0 && job->done_count.fetch_add(processed) + processed == count) {
+            const std::lock_guard<std::mutex> lock(job->mutex);
+            job->done.notify_all();
+        }
+    };
+
+    const uint32_t helper_count = std::min(size(), count - 1);
+    for (uint32_t i = 0; i < helper_count; i++)
+        push(process);
+    process();
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done.wait(lock, [&]() { return job->done_count == count; });
+}
+
+ThreadPool &get_worker_pool() {
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2U) - 1);
+    return pool;
+}
+
+} // namespace util